@@ -0,0 +1,14 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+
+/* Type of function for allocating size bytes of memory. Should return NULL if the allocation failed.
+ * context is the allocator context that was given together with the function */
+typedef void *(*AllocateFunction)(size_t size, void *context);
+
+/* Type of function for deallocating memory that was returned by the matching AllocateFunction */
+typedef void (*DeallocateFunction)(void *memory, void *context);
+
+
+#endif //ALLOCATOR_H
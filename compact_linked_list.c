@@ -0,0 +1,298 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "compact_linked_list.h"
+
+#define FIRST_CAPACITY 8
+#define MAX_CAPACITY (COMPACT_NULL_NODE - 1)
+
+struct compactNode {
+    NodeData data;
+    CompactNode prev;
+    CompactNode next;
+};
+
+struct compactList {
+    struct compactNode *nodes;
+    uint32_t capacity;
+    uint32_t used_count;
+    CompactNode head;
+    CompactNode tail;
+    CompactNode free_nodes;
+    uint32_t size;
+    AllocateFunction allocate;
+    DeallocateFunction deallocate;
+    void *allocator_context;
+};
+
+/* The allocation function used by lists that were created without an allocator */
+static void *defaultAllocate(size_t size, void *context) {
+    (void) context;
+    return malloc(size);
+}
+
+/* The deallocation function used by lists that were created without an allocator */
+static void defaultDeallocate(void *memory, void *context) {
+    (void) context;
+    free(memory);
+}
+
+/* Moves the nodes to a new array of new_capacity nodes. The handles stay the same, since they are indices */
+static bool growNodes(CompactList list, uint32_t new_capacity) {
+    struct compactNode *new_nodes = list->allocate(new_capacity * sizeof(struct compactNode),
+                                                   list->allocator_context);
+    if (new_nodes == NULL) {
+        return false;
+    }
+
+    if (list->nodes != NULL) {
+        memcpy(new_nodes, list->nodes, list->used_count * sizeof(struct compactNode));
+        list->deallocate(list->nodes, list->allocator_context);
+    }
+    list->nodes = new_nodes;
+    list->capacity = new_capacity;
+    return true;
+}
+
+/* Takes a node for node_data from the free nodes, or from the unused end of the array (which grows twice as big
+ * when it is full). The node is not linked into the list */
+static CompactNode createNode(CompactList list, NodeData node_data) {
+    CompactNode node = list->free_nodes;
+    if (node != COMPACT_NULL_NODE) {
+        list->free_nodes = list->nodes[node].next;
+    } else {
+        if (list->used_count == list->capacity) {
+            if (list->capacity == MAX_CAPACITY) {
+                return COMPACT_NULL_NODE;
+            }
+            uint32_t new_capacity = list->capacity < MAX_CAPACITY / 2 ? list->capacity * 2 : MAX_CAPACITY;
+            if (!growNodes(list, new_capacity < FIRST_CAPACITY ? FIRST_CAPACITY : new_capacity)) {
+                return COMPACT_NULL_NODE;
+            }
+        }
+        node = list->used_count;
+        list->used_count++;
+    }
+
+    list->nodes[node].data = node_data;
+    return node;
+}
+
+/* Links a node that is not in the list between prev and next (either may be COMPACT_NULL_NODE at the ends) */
+static CompactNode linkBetween(CompactList list, CompactNode prev, CompactNode next, CompactNode node) {
+    list->nodes[node].prev = prev;
+    list->nodes[node].next = next;
+    if (prev != COMPACT_NULL_NODE) {
+        list->nodes[prev].next = node;
+    } else {
+        list->head = node;
+    }
+    if (next != COMPACT_NULL_NODE) {
+        list->nodes[next].prev = node;
+    } else {
+        list->tail = node;
+    }
+    list->size++;
+    return node;
+}
+
+
+CompactList compactListCreate() {
+    return compactListCreateWithAllocator(defaultAllocate, defaultDeallocate, NULL);
+}
+
+CompactList compactListCreateWithAllocator(AllocateFunction allocate, DeallocateFunction deallocate, void *context) {
+    if (allocate == NULL || deallocate == NULL) {
+        return NULL;
+    }
+
+    CompactList list = allocate(sizeof(struct compactList), context);
+    if (list == NULL) {
+        return NULL;
+    }
+
+    list->nodes = NULL;
+    list->capacity = 0;
+    list->used_count = 0;
+    list->head = COMPACT_NULL_NODE;
+    list->tail = COMPACT_NULL_NODE;
+    list->free_nodes = COMPACT_NULL_NODE;
+    list->size = 0;
+    list->allocate = allocate;
+    list->deallocate = deallocate;
+    list->allocator_context = context;
+
+    return list;
+}
+
+CompactList compactListCreateWithCapacity(int capacity) {
+    if (capacity < 0) {
+        return NULL;
+    }
+
+    CompactList list = compactListCreate();
+    if (list != NULL && capacity > 0 && !growNodes(list, capacity)) {
+        compactListDestroy(list);
+        return NULL;
+    }
+    return list;
+}
+
+int compactListGetSize(CompactList list) {
+    if (list == NULL) {
+        return -1;
+    }
+    return list->size < INT_MAX ? (int) list->size : INT_MAX;
+}
+
+int64_t compactListGetSize64(CompactList list) {
+    if (list == NULL) {
+        return -1;
+    }
+    return list->size;
+}
+
+void compactListDestroy(CompactList list) {
+    if (list == NULL) {
+        return;
+    }
+
+    if (list->nodes != NULL) {
+        list->deallocate(list->nodes, list->allocator_context);
+    }
+    list->deallocate(list, list->allocator_context);
+}
+
+void compactListClear(CompactList list) {
+    if (list == NULL) {
+        return;
+    }
+
+    // All the nodes are unused again, so the array is simply handed out from its start
+    list->used_count = 0;
+    list->head = COMPACT_NULL_NODE;
+    list->tail = COMPACT_NULL_NODE;
+    list->free_nodes = COMPACT_NULL_NODE;
+    list->size = 0;
+}
+
+CompactNode compactListRemove(CompactList list, CompactNode node) {
+    if (list == NULL || node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+
+    CompactNode prev = list->nodes[node].prev;
+    CompactNode next = list->nodes[node].next;
+    if (prev != COMPACT_NULL_NODE) {
+        list->nodes[prev].next = next;
+    } else {
+        list->head = next;
+    }
+    if (next != COMPACT_NULL_NODE) {
+        list->nodes[next].prev = prev;
+    } else {
+        list->tail = prev;
+    }
+    list->size--;
+
+    list->nodes[node].next = list->free_nodes;
+    list->free_nodes = node;
+    return node;
+}
+
+CompactNode compactListRemoveFirst(CompactList list) {
+    if (list == NULL) {
+        return COMPACT_NULL_NODE;
+    }
+    return compactListRemove(list, list->head);
+}
+
+CompactNode compactListRemoveLast(CompactList list) {
+    if (list == NULL) {
+        return COMPACT_NULL_NODE;
+    }
+    return compactListRemove(list, list->tail);
+}
+
+CompactNode compactListInsertAfter(CompactList list, CompactNode target_node, NodeData node_data) {
+    if (list == NULL || target_node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+
+    CompactNode node = createNode(list, node_data);
+    if (node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+    return linkBetween(list, target_node, list->nodes[target_node].next, node);
+}
+
+CompactNode compactListInsertBefore(CompactList list, CompactNode target_node, NodeData node_data) {
+    if (list == NULL || target_node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+
+    CompactNode node = createNode(list, node_data);
+    if (node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+    return linkBetween(list, list->nodes[target_node].prev, target_node, node);
+}
+
+CompactNode compactListInsertStart(CompactList list, NodeData node_data) {
+    if (list == NULL) {
+        return COMPACT_NULL_NODE;
+    }
+
+    CompactNode node = createNode(list, node_data);
+    if (node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+    return linkBetween(list, COMPACT_NULL_NODE, list->head, node);
+}
+
+CompactNode compactListInsertEnd(CompactList list, NodeData node_data) {
+    if (list == NULL) {
+        return COMPACT_NULL_NODE;
+    }
+
+    CompactNode node = createNode(list, node_data);
+    if (node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+    return linkBetween(list, list->tail, COMPACT_NULL_NODE, node);
+}
+
+NodeData compactListGetData(CompactList list, CompactNode node) {
+    if (list == NULL || node == COMPACT_NULL_NODE) {
+        return NULL;
+    }
+    return list->nodes[node].data;
+}
+
+CompactNode compactListGetNext(CompactList list, CompactNode node) {
+    if (list == NULL || node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+    return list->nodes[node].next;
+}
+
+CompactNode compactListGetPrev(CompactList list, CompactNode node) {
+    if (list == NULL || node == COMPACT_NULL_NODE) {
+        return COMPACT_NULL_NODE;
+    }
+    return list->nodes[node].prev;
+}
+
+CompactNode compactListGetFirst(CompactList list) {
+    if (list == NULL) {
+        return COMPACT_NULL_NODE;
+    }
+    return list->head;
+}
+
+CompactNode compactListGetLast(CompactList list) {
+    if (list == NULL) {
+        return COMPACT_NULL_NODE;
+    }
+    return list->tail;
+}
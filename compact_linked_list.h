@@ -0,0 +1,90 @@
+#ifndef COMPACT_LINKED_LIST_H
+#define COMPACT_LINKED_LIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "allocator.h"
+#include "double_linked_list.h"
+
+/* A doubly linked list whose nodes live in a single growable array and link to each other by 32-bit indices,
+ * so a node takes 16 bytes (the data pointer and two indices) with no allocation of its own, and the nodes of
+ * the list stay close together in memory. Removed nodes are kept in a free list inside the array for reuse.
+ * Nodes are referred to by CompactNode handles, which are indices into the array, so they stay valid when the
+ * array grows (unlike pointers to its nodes). Since a handle is not a pointer, reading a node takes the list too */
+
+/* Type for defining the list nodes */
+typedef uint32_t CompactNode;
+/* Type for defining the list controller object */
+typedef struct compactList *CompactList;
+
+/* The handle that does not refer to any node (like a NULL LinkedNode) */
+#define COMPACT_NULL_NODE UINT32_MAX
+
+
+/* Creates a new list */
+CompactList compactListCreate();
+
+/* Creates a new list that allocates the list and its array of nodes with allocate and frees them with deallocate.
+ * context is passed to both functions on every call */
+CompactList compactListCreateWithAllocator(AllocateFunction allocate, DeallocateFunction deallocate, void *context);
+
+/* Creates a new list with room for capacity nodes, so the first capacity insertions do not allocate memory.
+ * Returns NULL if capacity is negative or allocations failed */
+CompactList compactListCreateWithCapacity(int capacity);
+
+/* Returns the amount of nodes currently in the list, or INT_MAX if there are more. Returns -1 if list is NULL */
+int compactListGetSize(CompactList list);
+
+/* Returns the amount of nodes currently in the list, which may exceed INT_MAX. Returns -1 if list is NULL */
+int64_t compactListGetSize64(CompactList list);
+
+/* Frees all the memory allocated by the list (does not free the data inserted to the list) */
+void compactListDestroy(CompactList list);
+
+/* Removes all the nodes from the list, keeping the array of nodes for reuse (does not free the data inserted to
+ * the list) */
+void compactListClear(CompactList list);
+
+/* Removes the given node parameter from the list. Its handle may be reused by later insertions */
+CompactNode compactListRemove(CompactList list, CompactNode node);
+
+/* Removes the first node in the list */
+CompactNode compactListRemoveFirst(CompactList list);
+
+/* Removes the last node in the list */
+CompactNode compactListRemoveLast(CompactList list);
+
+/* Inserts a node after the parameter target_node inside the list */
+CompactNode compactListInsertAfter(CompactList list, CompactNode target_node, NodeData node_data);
+
+/* Inserts a node before the parameter target_node inside the list */
+CompactNode compactListInsertBefore(CompactList list, CompactNode target_node, NodeData node_data);
+
+/* Inserts a node at the start of the list */
+CompactNode compactListInsertStart(CompactList list, NodeData node_data);
+
+/* Inserts a node at the end of the list */
+CompactNode compactListInsertEnd(CompactList list, NodeData node_data);
+
+/* Gets a node parameter and returns the data it points to */
+NodeData compactListGetData(CompactList list, CompactNode node);
+
+/* Gets a node parameter and returns the next node inline */
+CompactNode compactListGetNext(CompactList list, CompactNode node);
+
+/* Gets a node parameter and returns the previous node inline */
+CompactNode compactListGetPrev(CompactList list, CompactNode node);
+
+/* Gets a list parameter and returns its first node */
+CompactNode compactListGetFirst(CompactList list);
+
+/* Gets a list parameter and returns its last node */
+CompactNode compactListGetLast(CompactList list);
+
+/* Macro to iterate over all of the list nodes */
+#define COMPACT_LIST_FOREACH(list, iter) \
+    for(CompactNode iter = compactListGetFirst(list); iter != COMPACT_NULL_NODE; \
+        iter = compactListGetNext(list, iter))
+
+
+#endif //COMPACT_LINKED_LIST_H
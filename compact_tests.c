@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "test_utilities.h"
+#include "compact_linked_list.h"
+
+#define ITEMS_COUNT 1000
+
+
+static NodeData getItem(int number) {
+    return (NodeData) (intptr_t) number;
+}
+
+static int getNumber(CompactList list, CompactNode node) {
+    return (int) (intptr_t) compactListGetData(list, node);
+}
+
+
+/* ============= TESTING compactListCreate ============= */
+bool testCompactListCreateIsEmpty() {
+    bool result = true;
+    CompactList list = compactListCreate();
+    ASSERT_TEST(list != NULL, destroy);
+    ASSERT_TEST(compactListGetSize(list) == 0, destroy);
+    ASSERT_TEST(compactListGetFirst(list) == COMPACT_NULL_NODE, destroy);
+    ASSERT_TEST(compactListGetLast(list) == COMPACT_NULL_NODE, destroy);
+    ASSERT_TEST(compactListRemoveFirst(list) == COMPACT_NULL_NODE, destroy);
+    ASSERT_TEST(compactListGetSize(NULL) == -1, destroy);
+    ASSERT_TEST(compactListGetSize64(NULL) == -1, destroy);
+    ASSERT_TEST(compactListCreateWithCapacity(-1) == NULL, destroy);
+
+    destroy:
+    compactListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING compactListInsertEnd ============= */
+bool testCompactListHandlesStayValidWhenGrowing() {
+    bool result = true;
+    CompactList list = compactListCreate();
+    CompactNode first_node = compactListInsertEnd(list, getItem(0));
+    CompactNode nodes[ITEMS_COUNT];
+    nodes[0] = first_node;
+    for (int i = 1; i < ITEMS_COUNT; i++) {
+        nodes[i] = compactListInsertEnd(list, getItem(i));
+        ASSERT_TEST(nodes[i] != COMPACT_NULL_NODE, destroy);
+    }
+    ASSERT_TEST(compactListGetSize(list) == ITEMS_COUNT, destroy);
+    ASSERT_TEST(compactListGetSize64(list) == ITEMS_COUNT, destroy);
+
+    // The array grew several times, but every handle still refers to its node
+    ASSERT_TEST(compactListGetFirst(list) == first_node, destroy);
+    for (int i = 0; i < ITEMS_COUNT; i++) {
+        ASSERT_TEST(getNumber(list, nodes[i]) == i, destroy);
+    }
+
+    int expected = ITEMS_COUNT - 1;
+    for (CompactNode node = compactListGetLast(list); node != COMPACT_NULL_NODE;
+         node = compactListGetPrev(list, node)) {
+        ASSERT_TEST(getNumber(list, node) == expected, destroy);
+        expected--;
+    }
+    ASSERT_TEST(expected == -1, destroy);
+
+    destroy:
+    compactListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING compactListRemove ============= */
+bool testCompactListRemoveReusesNodes() {
+    bool result = true;
+    CompactList list = compactListCreateWithCapacity(4);
+    CompactNode middle_node = compactListInsertStart(list, getItem(2));
+    ASSERT_TEST(compactListInsertBefore(list, middle_node, getItem(1)) != COMPACT_NULL_NODE, destroy);
+    ASSERT_TEST(compactListInsertAfter(list, middle_node, getItem(3)) != COMPACT_NULL_NODE, destroy);
+    ASSERT_TEST(compactListInsertStart(list, getItem(0)) != COMPACT_NULL_NODE, destroy);
+
+    int expected = 0;
+    COMPACT_LIST_FOREACH(list, node) {
+        ASSERT_TEST(getNumber(list, node) == expected, destroy);
+        expected++;
+    }
+
+    // A removed node is reused by the next insertion
+    ASSERT_TEST(compactListRemove(list, middle_node) == middle_node, destroy);
+    ASSERT_TEST(compactListInsertEnd(list, getItem(4)) == middle_node, destroy);
+    ASSERT_TEST(getNumber(list, compactListRemoveFirst(list)) == 0, destroy);
+    ASSERT_TEST(compactListRemoveLast(list) == middle_node, destroy);
+    ASSERT_TEST(compactListGetSize(list) == 2, destroy);
+    ASSERT_TEST(getNumber(list, compactListGetFirst(list)) == 1, destroy);
+    ASSERT_TEST(getNumber(list, compactListGetLast(list)) == 3, destroy);
+
+    compactListClear(list);
+    ASSERT_TEST(compactListGetSize(list) == 0, destroy);
+    ASSERT_TEST(compactListGetFirst(list) == COMPACT_NULL_NODE, destroy);
+
+    destroy:
+    compactListDestroy(list);
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testCompactListCreateIsEmpty,
+        testCompactListHandlesStayValidWhenGrowing,
+        testCompactListRemoveReusesNodes
+};
+
+const char *testNames[] = {
+        "testCompactListCreateIsEmpty",
+        "testCompactListHandlesStayValidWhenGrowing",
+        "testCompactListRemoveReusesNodes"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testCompactListCreateIsEmpty",
+        "Please refer to the testing code at function: testCompactListHandlesStayValidWhenGrowing",
+        "Please refer to the testing code at function: testCompactListRemoveReusesNodes"
+};
+
+
+#define NUMBER_TESTS 3
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: compact_linked_list_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}
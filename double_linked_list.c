@@ -1,24 +1,194 @@
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <assert.h>
 #include "double_linked_list.h"
 
+#define FIRST_CHUNK_NODES 8
+#define MAX_CHUNK_NODES 1024
+
 struct linkedNode {
     NodeData data;
     LinkedNode prev;
     LinkedNode next;
 };
 
+/* A block of nodes allocated at once. The chunks of a pool are chained by their next pointers, and are freed
+ * only when the last list of the pool is cleared or destroyed */
+typedef struct nodeChunk {
+    struct nodeChunk *next;
+    int64_t nodes_count;
+    struct linkedNode nodes[];
+} *NodeChunk;
+
+/* The memory of the nodes of one or more lists. Every list starts with a pool of its own, and lists share a pool
+ * once nodes were moved between them (see joinPools). Spare nodes are chained by their next pointers */
+typedef struct nodePool {
+    NodeChunk chunks;
+    NodeChunk last_chunk;
+    LinkedNode spare_nodes;
+    LinkedNode last_spare_node;
+    int next_chunk_nodes;
+    int lists_count;
+    AllocateFunction allocate;
+    DeallocateFunction deallocate;
+    void *allocator_context;
+} *NodePool;
+
 struct linkedList {
     LinkedNode head;
-    int size;
+    LinkedNode tail;
+    int64_t size;
+    NodePool pool;
 };
 
-/* Creates a new list node with it's data pointing to node_data */
-static NodeData createNode(NodeData node_data) {
-    LinkedNode node = malloc(sizeof(struct linkedNode));
-    if (node == NULL) {
+/* The allocation function used by lists that were created without an allocator */
+static void *defaultAllocate(size_t size, void *context) {
+    (void) context;
+    return malloc(size);
+}
+
+/* The deallocation function used by lists that were created without an allocator */
+static void defaultDeallocate(void *memory, void *context) {
+    (void) context;
+    free(memory);
+}
+
+static NodePool createPool(AllocateFunction allocate, DeallocateFunction deallocate, void *context) {
+    NodePool pool = allocate(sizeof(struct nodePool), context);
+    if (pool == NULL) {
         return NULL;
     }
+
+    pool->chunks = NULL;
+    pool->last_chunk = NULL;
+    pool->spare_nodes = NULL;
+    pool->last_spare_node = NULL;
+    pool->next_chunk_nodes = FIRST_CHUNK_NODES;
+    pool->lists_count = 1;
+    pool->allocate = allocate;
+    pool->deallocate = deallocate;
+    pool->allocator_context = context;
+    return pool;
+}
+
+/* Frees all the chunks of the pool, and with them all of its nodes */
+static void destroyChunks(NodePool pool) {
+    NodeChunk chunk = pool->chunks;
+    while (chunk != NULL) {
+        NodeChunk next_chunk = chunk->next;
+        pool->deallocate(chunk, pool->allocator_context);
+        chunk = next_chunk;
+    }
+    pool->chunks = NULL;
+    pool->last_chunk = NULL;
+    pool->spare_nodes = NULL;
+    pool->last_spare_node = NULL;
+    pool->next_chunk_nodes = FIRST_CHUNK_NODES;
+}
+
+/* Removes a list from its pool, and frees the pool once no list uses it */
+static void releasePool(NodePool pool) {
+    pool->lists_count--;
+    if (pool->lists_count == 0) {
+        destroyChunks(pool);
+        pool->deallocate(pool, pool->allocator_context);
+    }
+}
+
+/* Adds a chain of nodes (from first_node to last_node, linked by their next pointers) to the spare nodes */
+static void addSpareNodes(NodePool pool, LinkedNode first_node, LinkedNode last_node) {
+    last_node->next = pool->spare_nodes;
+    if (pool->spare_nodes == NULL) {
+        pool->last_spare_node = last_node;
+    }
+    pool->spare_nodes = first_node;
+}
+
+/* Allocates a chunk of nodes_count nodes and adds all of them to the pool's spare nodes.
+ * Every chunk is twice as big as the one before it (up to MAX_CHUNK_NODES), unless a bigger one was reserved */
+static bool addChunk(NodePool pool, int64_t nodes_count) {
+    NodeChunk chunk = pool->allocate(sizeof(struct nodeChunk) + nodes_count * sizeof(struct linkedNode),
+                                     pool->allocator_context);
+    if (chunk == NULL) {
+        return false;
+    }
+
+    chunk->nodes_count = nodes_count;
+    chunk->next = pool->chunks;
+    if (pool->chunks == NULL) {
+        pool->last_chunk = chunk;
+    }
+    pool->chunks = chunk;
+    for (int64_t i = 0; i < nodes_count - 1; i++) {
+        chunk->nodes[i].next = &chunk->nodes[i + 1];
+    }
+    addSpareNodes(pool, &chunk->nodes[0], &chunk->nodes[nodes_count - 1]);
+
+    if (nodes_count * 2 > pool->next_chunk_nodes) {
+        pool->next_chunk_nodes = nodes_count * 2 < MAX_CHUNK_NODES ? nodes_count * 2 : MAX_CHUNK_NODES;
+    }
+    return true;
+}
+
+/* Moves all the chunks and spare nodes of from_pool to into_pool, in O(1), and frees from_pool */
+static void mergePool(NodePool into_pool, NodePool from_pool) {
+    if (from_pool->chunks != NULL) {
+        from_pool->last_chunk->next = into_pool->chunks;
+        if (into_pool->chunks == NULL) {
+            into_pool->last_chunk = from_pool->last_chunk;
+        }
+        into_pool->chunks = from_pool->chunks;
+    }
+    if (from_pool->spare_nodes != NULL) {
+        addSpareNodes(into_pool, from_pool->spare_nodes, from_pool->last_spare_node);
+    }
+    if (from_pool->next_chunk_nodes > into_pool->next_chunk_nodes) {
+        into_pool->next_chunk_nodes = from_pool->next_chunk_nodes;
+    }
+    from_pool->deallocate(from_pool, from_pool->allocator_context);
+}
+
+/* Makes the two lists use the same pool, so nodes can be moved from one to the other. A pool that only one of
+ * them uses is merged into the pool of the other one. Returns false if both already share their pools with other
+ * lists, or the pools have different allocators */
+static bool joinPools(LinkedList list, LinkedList other_list) {
+    NodePool pool = list->pool;
+    NodePool other_pool = other_list->pool;
+    if (pool == other_pool) {
+        return true;
+    }
+    if (pool->allocate != other_pool->allocate || pool->deallocate != other_pool->deallocate ||
+        pool->allocator_context != other_pool->allocator_context) {
+        return false;
+    }
+
+    if (other_pool->lists_count == 1) {
+        mergePool(pool, other_pool);
+        other_list->pool = pool;
+    } else if (pool->lists_count == 1) {
+        mergePool(other_pool, pool);
+        list->pool = other_pool;
+    } else {
+        return false;
+    }
+    list->pool->lists_count++;
+    return true;
+}
+
+/* Creates a new list node with it's data pointing to node_data. Nodes are taken from the spare nodes of the
+ * list's pool, which get a new chunk when they run out */
+static NodeData createNode(LinkedList list, NodeData node_data) {
+    NodePool pool = list->pool;
+    if (pool->spare_nodes == NULL && !addChunk(pool, pool->next_chunk_nodes)) {
+        return NULL;
+    }
+    LinkedNode node = pool->spare_nodes;
+    pool->spare_nodes = node->next;
+    if (pool->spare_nodes == NULL) {
+        pool->last_spare_node = NULL;
+    }
+
     node->data = node_data;
     node->next = NULL;
     node->prev = NULL;
@@ -26,30 +196,211 @@ static NodeData createNode(NodeData node_data) {
     return node;
 }
 
+/* Replaces the nodes from *first_node to *last_node (in this order in source_list) by new nodes with the same data,
+ * taken from the pool of list, and sets *first_node and *last_node to the new ones. The old nodes become spare
+ * nodes of source_list's pool. This lets nodes move between lists that cannot share a pool (see joinPools), one by
+ * one, and the new nodes must be moved to list right after it. Returns false if allocations failed, in which case
+ * nothing is changed */
+static bool adoptNodes(LinkedList list, LinkedList source_list, LinkedNode *first_node, LinkedNode *last_node) {
+    LinkedNode first_new_node = NULL;
+    LinkedNode last_new_node = NULL;
+    for (LinkedNode node = *first_node; node != (*last_node)->next; node = node->next) {
+        LinkedNode new_node = createNode(list, node->data);
+        if (new_node == NULL) {
+            if (first_new_node != NULL) {
+                addSpareNodes(list->pool, first_new_node, last_new_node);
+            }
+            return false;
+        }
+        new_node->prev = last_new_node;
+        if (last_new_node != NULL) {
+            last_new_node->next = new_node;
+        } else {
+            first_new_node = new_node;
+        }
+        last_new_node = new_node;
+    }
+
+    first_new_node->prev = (*first_node)->prev;
+    last_new_node->next = (*last_node)->next;
+    if (first_new_node->prev != NULL) {
+        first_new_node->prev->next = first_new_node;
+    } else {
+        source_list->head = first_new_node;
+    }
+    if (last_new_node->next != NULL) {
+        last_new_node->next->prev = last_new_node;
+    } else {
+        source_list->tail = last_new_node;
+    }
+
+    addSpareNodes(source_list->pool, *first_node, *last_node);
+    *first_node = first_new_node;
+    *last_node = last_new_node;
+    return true;
+}
+
+/* Returns the amount of nodes in the chain from first_node to last_node (linked by their next pointers) */
+static int64_t countNodes(LinkedNode first_node, LinkedNode last_node) {
+    int64_t count = 1;
+    for (LinkedNode node = first_node; node != last_node; node = node->next) {
+        count++;
+    }
+    return count;
+}
+
+
+/* Detaches node from the list without freeing it */
+static void unlinkNode(LinkedList list, LinkedNode node) {
+    if (list->head == node) {
+        list->head = node->next;
+    }
+    if (list->tail == node) {
+        list->tail = node->prev;
+    }
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    }
+
+    node->prev = NULL;
+    node->next = NULL;
+    list->size--;
+}
+
+/* Links a detached node into the list right after target_node */
+static void linkAfter(LinkedList list, LinkedNode target_node, LinkedNode node) {
+    if(target_node->next != NULL) {
+        target_node->next->prev = node;
+    } else {
+        list->tail = node;
+    }
+    node->prev = target_node;
+    node->next = target_node->next;
+    target_node->next = node;
+    list->size++;
+}
+
+/* Links a detached node into the list as its first node */
+static void linkAtStart(LinkedList list, LinkedNode node) {
+    if(list->head != NULL) {
+        list->head->prev = node;
+    } else {
+        list->tail = node;
+    }
+
+    node->prev = NULL;
+    node->next = list->head;
+    list->head = node;
+    list->size++;
+}
+
+/* Sets the prev pointers of the list's nodes and its tail by their next pointers, after the nodes were relinked
+ * only by their next pointers */
+static void restorePrevLinks(LinkedList list) {
+    LinkedNode prev_node = NULL;
+    for (LinkedNode node = list->head; node != NULL; node = node->next) {
+        node->prev = prev_node;
+        prev_node = node;
+    }
+    list->tail = prev_node;
+}
+
 
 LinkedList listCreate() {
-    LinkedList list = malloc(sizeof(struct linkedList));
+    return listCreateWithAllocator(defaultAllocate, defaultDeallocate, NULL);
+}
+
+LinkedList listCreateWithAllocator(AllocateFunction allocate, DeallocateFunction deallocate, void *context) {
+    if (allocate == NULL || deallocate == NULL) {
+        return NULL;
+    }
+
+    LinkedList list = allocate(sizeof(struct linkedList), context);
     if (list == NULL) {
         return NULL;
     }
+    list->pool = createPool(allocate, deallocate, context);
+    if (list->pool == NULL) {
+        deallocate(list, context);
+        return NULL;
+    }
 
     list->head = NULL;
+    list->tail = NULL;
     list->size = 0;
 
     return list;
 }
 
+LinkedList listCreateWithCapacity(int capacity) {
+    LinkedList list = listCreate();
+    if (list != NULL && !listReserve(list, capacity)) {
+        listDestroy(list);
+        return NULL;
+    }
+    return list;
+}
+
+bool listReserve(LinkedList list, int capacity) {
+    return listReserve64(list, capacity);
+}
+
+bool listReserve64(LinkedList list, int64_t capacity) {
+    if (list == NULL || capacity < 0) {
+        return false;
+    }
+
+    int64_t available_count = list->size;
+    for (LinkedNode node = list->pool->spare_nodes; node != NULL && available_count < capacity;
+         node = node->next) {
+        available_count++;
+    }
+    if (available_count >= capacity) {
+        return true;
+    }
+    return addChunk(list->pool, capacity - available_count);
+}
 
 void listDestroy(LinkedList list) {
     if(list == NULL) {
         return;
     }
 
-    LIST_FOREACH(list, node){
-        free(node);
+    listClear(list);
+    DeallocateFunction deallocate = list->pool->deallocate;
+    void *allocator_context = list->pool->allocator_context;
+    releasePool(list->pool);
+    deallocate(list, allocator_context);
+}
+
+void listClear(LinkedList list) {
+    if (list == NULL) {
+        return;
+    }
+
+    // Chunks shared with other lists still hold their nodes, so the nodes of this list are only made spare
+    if (list->pool->lists_count == 1) {
+        destroyChunks(list->pool);
+    } else if (list->head != NULL) {
+        addSpareNodes(list->pool, list->head, list->tail);
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
+
+void listClearKeepCapacity(LinkedList list) {
+    if (list == NULL || list->head == NULL) {
+        return;
     }
 
-    free(list);
+    addSpareNodes(list->pool, list->head, list->tail);
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
 }
 
 LinkedNode listRemove(LinkedList list, LinkedNode node) {
@@ -57,18 +408,8 @@ LinkedNode listRemove(LinkedList list, LinkedNode node) {
         return NULL;
     }
 
-    if (list->head == node) {
-        list->head = node->next;
-    }
-    if (node->prev != NULL) {
-        node->prev->next = node->next;
-    }
-    if (node->next != NULL) {
-        node->next->prev = node->prev;
-    }
-
-    free(node);
-    list->size--;
+    unlinkNode(list, node);
+    addSpareNodes(list->pool, node, node);
     return node;
 }
 
@@ -76,46 +417,269 @@ LinkedNode listRemoveFirst(LinkedList list) {
     return listRemove(list, list->head);
 }
 
+LinkedNode listRemoveLast(LinkedList list) {
+    if (list == NULL) {
+        return NULL;
+    }
+    return listRemove(list, list->tail);
+}
+
 LinkedNode listInsertAfter(LinkedList list, LinkedNode target_node, NodeData node_data) {
     if (target_node == NULL) {
         return NULL;
     }
 
-    LinkedNode node = createNode(node_data);
+    LinkedNode node = createNode(list, node_data);
     if (node == NULL) {
         return NULL;
     }
 
-    if(target_node->next != NULL) {
-        target_node->next->prev = node;
-    }
-    node->prev = target_node;
-    node->next = target_node->next;
-    target_node->next = node;
-    list->size++;
-
+    linkAfter(list, target_node, node);
     return node;
 }
 
+LinkedNode listInsertBefore(LinkedList list, LinkedNode target_node, NodeData node_data) {
+    if (target_node == NULL) {
+        return NULL;
+    }
+    if (target_node->prev == NULL) {
+        return listInsertStart(list, node_data);
+    }
+    return listInsertAfter(list, target_node->prev, node_data);
+}
+
 LinkedNode listInsertStart(LinkedList list, NodeData node_data) {
     if (list == NULL) {
         return NULL;
     }
-    LinkedNode node = createNode(node_data);
+    LinkedNode node = createNode(list, node_data);
     if (node == NULL) {
         return NULL;
     }
 
-    if(list->head != NULL) {
-        list->head->prev = node;
+    linkAtStart(list, node);
+    return node;
+}
+
+LinkedNode listInsertEnd(LinkedList list, NodeData node_data) {
+    if (list == NULL) {
+        return NULL;
+    }
+    if (list->tail == NULL) {
+        return listInsertStart(list, node_data);
     }
+    return listInsertAfter(list, list->tail, node_data);
+}
 
-    node->next = list->head;
-    list->head = node;
-    list->size++;
+LinkedNode listMoveAfter(LinkedList list, LinkedNode node, LinkedNode target_node) {
+    if (list == NULL || node == NULL || target_node == NULL) {
+        return NULL;
+    }
+    if (node == target_node) {
+        return node;
+    }
+
+    unlinkNode(list, node);
+    linkAfter(list, target_node, node);
+    return node;
+}
+
+LinkedNode listMoveToStart(LinkedList list, LinkedNode node) {
+    if (list == NULL || node == NULL) {
+        return NULL;
+    }
+
+    unlinkNode(list, node);
+    linkAtStart(list, node);
     return node;
 }
 
+bool listSpliceAfter(LinkedList list, LinkedNode target_node, LinkedList source_list, LinkedNode first_node,
+                     LinkedNode last_node) {
+    if (list == NULL || source_list == NULL || first_node == NULL || last_node == NULL) {
+        return false;
+    }
+    if (!joinPools(list, source_list) && !adoptNodes(list, source_list, &first_node, &last_node)) {
+        return false;
+    }
+    int64_t moved_count = countNodes(first_node, last_node);
+
+    // Detaches the range from source_list
+    if (first_node->prev != NULL) {
+        first_node->prev->next = last_node->next;
+    } else {
+        source_list->head = last_node->next;
+    }
+    if (last_node->next != NULL) {
+        last_node->next->prev = first_node->prev;
+    } else {
+        source_list->tail = first_node->prev;
+    }
+    source_list->size -= moved_count;
+
+    // And links it into list
+    LinkedNode next_node = target_node != NULL ? target_node->next : list->head;
+    first_node->prev = target_node;
+    last_node->next = next_node;
+    if (target_node != NULL) {
+        target_node->next = first_node;
+    } else {
+        list->head = first_node;
+    }
+    if (next_node != NULL) {
+        next_node->prev = last_node;
+    } else {
+        list->tail = last_node;
+    }
+    list->size += moved_count;
+    return true;
+}
+
+bool listConcat(LinkedList list, LinkedList source_list) {
+    if (list == NULL || source_list == NULL || list == source_list) {
+        return false;
+    }
+    if (source_list->head == NULL) {
+        return true;
+    }
+    LinkedNode first_node = source_list->head;
+    LinkedNode last_node = source_list->tail;
+    if (!joinPools(list, source_list) && !adoptNodes(list, source_list, &first_node, &last_node)) {
+        return false;
+    }
+
+    source_list->head->prev = list->tail;
+    if (list->tail != NULL) {
+        list->tail->next = source_list->head;
+    } else {
+        list->head = source_list->head;
+    }
+    list->tail = source_list->tail;
+    list->size += source_list->size;
+
+    source_list->head = NULL;
+    source_list->tail = NULL;
+    source_list->size = 0;
+    return true;
+}
+
+LinkedList listSplitAfter(LinkedList list, LinkedNode node) {
+    if (list == NULL || node == NULL) {
+        return NULL;
+    }
+
+    LinkedList new_list = list->pool->allocate(sizeof(struct linkedList), list->pool->allocator_context);
+    if (new_list == NULL) {
+        return NULL;
+    }
+    new_list->pool = list->pool;
+    list->pool->lists_count++;
+
+    new_list->head = node->next;
+    new_list->tail = node->next != NULL ? list->tail : NULL;
+    new_list->size = node->next != NULL ? countNodes(node->next, list->tail) : 0;
+    if (new_list->head != NULL) {
+        new_list->head->prev = NULL;
+    }
+
+    node->next = NULL;
+    list->tail = node;
+    list->size -= new_list->size;
+    return new_list;
+}
+
+void listSort(LinkedList list, CompareNodeData compare) {
+    if (list == NULL || compare == NULL || list->size < 2) {
+        return;
+    }
+
+    // Every pass merges pairs of sorted runs of run_size nodes, which are linked by their next pointers only
+    for (int64_t run_size = 1; run_size < list->size; run_size *= 2) {
+        LinkedNode left_node = list->head;
+        LinkedNode merged_tail = NULL;
+        list->head = NULL;
+
+        while (left_node != NULL) {
+            LinkedNode right_node = left_node;
+            int64_t left_size = 0;
+            while (left_size < run_size && right_node != NULL) {
+                right_node = right_node->next;
+                left_size++;
+            }
+            int64_t right_size = run_size;
+
+            while (left_size > 0 || (right_size > 0 && right_node != NULL)) {
+                LinkedNode next_node;
+                // Taking the left node on equality keeps the sort stable
+                if (left_size > 0 && (right_size == 0 || right_node == NULL ||
+                                      compare(left_node->data, right_node->data) <= 0)) {
+                    next_node = left_node;
+                    left_node = left_node->next;
+                    left_size--;
+                } else {
+                    next_node = right_node;
+                    right_node = right_node->next;
+                    right_size--;
+                }
+
+                if (merged_tail != NULL) {
+                    merged_tail->next = next_node;
+                } else {
+                    list->head = next_node;
+                }
+                merged_tail = next_node;
+            }
+            left_node = right_node;
+        }
+        merged_tail->next = NULL;
+    }
+
+    restorePrevLinks(list);
+}
+
+bool listMergeSorted(LinkedList list, LinkedList source_list, CompareNodeData compare) {
+    if (list == NULL || source_list == NULL || compare == NULL || list == source_list) {
+        return false;
+    }
+    if (source_list->head == NULL) {
+        return true;
+    }
+    LinkedNode first_node = source_list->head;
+    LinkedNode last_node = source_list->tail;
+    if (!joinPools(list, source_list) && !adoptNodes(list, source_list, &first_node, &last_node)) {
+        return false;
+    }
+
+    LinkedNode node = list->head;
+    LinkedNode source_node = source_list->head;
+    LinkedNode merged_tail = NULL;
+    list->head = NULL;
+    while (node != NULL || source_node != NULL) {
+        LinkedNode next_node;
+        if (source_node == NULL || (node != NULL && compare(node->data, source_node->data) <= 0)) {
+            next_node = node;
+            node = node->next;
+        } else {
+            next_node = source_node;
+            source_node = source_node->next;
+        }
+
+        if (merged_tail != NULL) {
+            merged_tail->next = next_node;
+        } else {
+            list->head = next_node;
+        }
+        merged_tail = next_node;
+    }
+    restorePrevLinks(list);
+    list->size += source_list->size;
+
+    source_list->head = NULL;
+    source_list->tail = NULL;
+    source_list->size = 0;
+    return true;
+}
+
 NodeData listGetData(LinkedNode node) {
     if (node == NULL) {
         return NULL;
@@ -124,6 +688,13 @@ NodeData listGetData(LinkedNode node) {
 }
 
 int listGetSize(LinkedList list) {
+    if(list == NULL) {
+        return -1;
+    }
+    return list->size < INT_MAX ? (int) list->size : INT_MAX;
+}
+
+int64_t listGetSize64(LinkedList list) {
     if(list == NULL) {
         return -1;
     }
@@ -151,3 +722,10 @@ LinkedNode listGetFirst(LinkedList list) {
     return list->head;
 }
 
+
+LinkedNode listGetLast(LinkedList list) {
+    if (list == NULL) {
+        return NULL;
+    }
+    return list->tail;
+}
@@ -2,6 +2,8 @@
 #define LINKED_LIST_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "allocator.h"
 
 /* Type for defining the list nodes */
 typedef struct linkedNode *LinkedNode;
@@ -11,43 +13,127 @@ typedef struct linkedList *LinkedList;
 /* Data element data type for the list */
 typedef void *NodeData;
 
+/* Type of function for comparing the data of two nodes. Should return a positive integer if the first one is
+ * greater, 0 if they are equal and a negative integer if the second one is greater */
+typedef int(*CompareNodeData)(NodeData, NodeData);
+
 
 /* Creates a new list */
 LinkedList listCreate();
 
-/* Returns the amount of nodes currently in the list */
+/* Creates a new list that allocates the list and all of its nodes with allocate and frees them with deallocate.
+ * context is passed to both functions on every call */
+LinkedList listCreateWithAllocator(AllocateFunction allocate, DeallocateFunction deallocate, void *context);
+
+/* Creates a new list with room for capacity nodes, so the first capacity insertions do not allocate memory.
+ * Returns NULL if capacity is negative or allocations failed */
+LinkedList listCreateWithCapacity(int capacity);
+
+/* Makes sure the list has room for capacity nodes (including the ones already in it) without allocating memory
+ * on insertions. Returns false if list is NULL, capacity is negative or allocations failed */
+bool listReserve(LinkedList list, int capacity);
+
+/* Same as listReserve, for a capacity that may exceed INT_MAX */
+bool listReserve64(LinkedList list, int64_t capacity);
+
+/* Returns the amount of nodes currently in the list, or INT_MAX if there are more. Returns -1 if list is NULL */
 int listGetSize(LinkedList list);
 
+/* Returns the amount of nodes currently in the list, which may exceed INT_MAX. Returns -1 if list is NULL */
+int64_t listGetSize64(LinkedList list);
+
 /* Frees all the memory allocated by the list (does not free the data inserted to the list) */
 void listDestroy(LinkedList list);
 
-/* Removes the given node parameter from the list */
+/* Removes all the nodes from the list and frees their memory, unless it is shared with other lists (see
+ * listSpliceAfter) (does not free the data inserted to the list) */
+void listClear(LinkedList list);
+
+/* Removes all the nodes from the list in O(1), keeping their memory for reuse by later insertions.
+ * The memory is freed by listClear or listDestroy */
+void listClearKeepCapacity(LinkedList list);
+
+/* Removes the given node parameter from the list. Its memory is kept by the list for later insertions */
 LinkedNode listRemove(LinkedList list, LinkedNode node);
 
 /* Removes the first node in the list */
 LinkedNode listRemoveFirst(LinkedList list);
 
+/* Removes the last node in the list (O(1), the list keeps a tail pointer) */
+LinkedNode listRemoveLast(LinkedList list);
+
 /* Inserts a node after the parameter target_node inside the list */
 LinkedNode listInsertAfter(LinkedList list, LinkedNode target_node, NodeData node_data);
 
+/* Inserts a node before the parameter target_node inside the list */
+LinkedNode listInsertBefore(LinkedList list, LinkedNode target_node, NodeData node_data);
+
 /* Inserts a node at the start of the list */
 LinkedNode listInsertStart(LinkedList list, NodeData node_data);
 
+/* Inserts a node at the end of the list (O(1), the list keeps a tail pointer) */
+LinkedNode listInsertEnd(LinkedList list, NodeData node_data);
+
+/* Moves the nodes from first_node to last_node (which must be in this order in source_list) out of source_list and
+ * links them right after target_node in list (or at its start if target_node is NULL), without reallocating them.
+ * list and source_list may be the same list if target_node is not one of the moved nodes.
+ * Takes O(1) besides counting the moved nodes. Lists that nodes were moved between share the memory of their nodes
+ * from then on, which is freed once all of them are destroyed.
+ * If the lists cannot share their memory (both already share it with other lists, or they have different
+ * allocators), the nodes are moved one by one instead: every moved node is replaced by a new node of list with the
+ * same data, in O(1) per node, so the handles of the moved nodes are no longer valid.
+ * Returns false if a NULL was sent (other than target_node), or allocating the new nodes failed (the lists are
+ * not changed then) */
+bool listSpliceAfter(LinkedList list, LinkedNode target_node, LinkedList source_list, LinkedNode first_node,
+                     LinkedNode last_node);
+
+/* Moves all the nodes of source_list to the end of list in O(1), leaving source_list empty. If the lists cannot
+ * share their memory, the nodes are moved one by one, and their handles are no longer valid (see listSpliceAfter).
+ * Returns false in the same cases as listSpliceAfter, or if list and source_list are the same list */
+bool listConcat(LinkedList list, LinkedList source_list);
+
+/* Moves all the nodes after node to a new list, which is returned (it shares the memory of its nodes with list).
+ * Takes O(1) besides counting the moved nodes. Returns NULL if a NULL was sent or allocations failed */
+LinkedList listSplitAfter(LinkedList list, LinkedNode node);
+
+/* Sorts the list in ascending order by compare, in O(n log n) and without allocating memory (a bottom-up merge
+ * sort of the nodes themselves). The sort is stable: nodes with equal data keep their order */
+void listSort(LinkedList list, CompareNodeData compare);
+
+/* Merges the nodes of source_list (sorted by compare) into list (sorted by compare too) in O(n), leaving
+ * source_list empty. Nodes of list come before equal nodes of source_list. If the lists cannot share their memory,
+ * the nodes of source_list are moved one by one, and their handles are no longer valid (see listSpliceAfter).
+ * Returns false in the same cases as listConcat, and the lists are not changed */
+bool listMergeSorted(LinkedList list, LinkedList source_list, CompareNodeData compare);
+
+/* Moves node (already in the list) to right after target_node without reallocating it */
+LinkedNode listMoveAfter(LinkedList list, LinkedNode node, LinkedNode target_node);
+
+/* Moves node (already in the list) to the start of the list without reallocating it */
+LinkedNode listMoveToStart(LinkedList list, LinkedNode node);
+
 /* Gets a node parameter and returns the data it points to */
 NodeData listGetData(LinkedNode node);
 
 /* Gets a node parameter and returns the next node inline (the one node points to) */
 LinkedNode listGetNext(LinkedNode node);
 
-/* Gets a node parameter and returns the next node inline (the one node points to forwards) */
+/* Gets a node parameter and returns the previous node inline (the one node points to backwards) */
 LinkedNode listGetPrev(LinkedNode node);
 
-/* Gets a node parameter and returns the previous node inline (the one node points to backwards) */
+/* Gets a list parameter and returns its first node */
 LinkedNode listGetFirst(LinkedList list);
 
+/* Gets a list parameter and returns its last node (O(1), the list keeps a tail pointer) */
+LinkedNode listGetLast(LinkedList list);
+
 /* Macro to iterate over all of the list nodes */
 #define LIST_FOREACH(list, iter) \
     for(LinkedNode iter = listGetFirst(list); iter != NULL; iter = listGetNext(iter))
 
+/* Macro to iterate over all of the list nodes from the last one to the first one */
+#define LIST_FOREACH_REVERSE(list, iter) \
+    for(LinkedNode iter = listGetLast(list); iter != NULL; iter = listGetPrev(iter))
+
 
 #endif //LINKED_LIST_H
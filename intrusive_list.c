@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include "intrusive_list.h"
+
+/* Links hook between prev and next, which are adjacent in a list (or both the sentinel of an empty list) */
+static void linkBetween(ListHook *prev, ListHook *next, ListHook *hook) {
+    hook->prev = prev;
+    hook->next = next;
+    prev->next = hook;
+    next->prev = hook;
+}
+
+/* Returns hook, or NULL if it is the sentinel of the list */
+static ListHook *getItemHook(IntrusiveList *list, ListHook *hook) {
+    return hook == &list->sentinel ? NULL : hook;
+}
+
+
+void intrusiveListInit(IntrusiveList *list) {
+    if (list == NULL) {
+        return;
+    }
+    list->sentinel.prev = &list->sentinel;
+    list->sentinel.next = &list->sentinel;
+}
+
+void listHookInit(ListHook *hook) {
+    if (hook == NULL) {
+        return;
+    }
+    hook->prev = NULL;
+    hook->next = NULL;
+}
+
+bool listHookIsLinked(ListHook *hook) {
+    return hook != NULL && hook->next != NULL;
+}
+
+bool intrusiveListIsEmpty(IntrusiveList *list) {
+    return list == NULL || list->sentinel.next == &list->sentinel;
+}
+
+int intrusiveListGetSize(IntrusiveList *list) {
+    if (list == NULL) {
+        return -1;
+    }
+
+    int size = 0;
+    INTRUSIVE_LIST_FOREACH(list, hook) {
+        size++;
+    }
+    return size;
+}
+
+void intrusiveListInsertAfter(ListHook *target_hook, ListHook *hook) {
+    if (target_hook == NULL || hook == NULL) {
+        return;
+    }
+    linkBetween(target_hook, target_hook->next, hook);
+}
+
+void intrusiveListInsertBefore(ListHook *target_hook, ListHook *hook) {
+    if (target_hook == NULL || hook == NULL) {
+        return;
+    }
+    linkBetween(target_hook->prev, target_hook, hook);
+}
+
+void intrusiveListInsertStart(IntrusiveList *list, ListHook *hook) {
+    if (list == NULL) {
+        return;
+    }
+    intrusiveListInsertAfter(&list->sentinel, hook);
+}
+
+void intrusiveListInsertEnd(IntrusiveList *list, ListHook *hook) {
+    if (list == NULL) {
+        return;
+    }
+    intrusiveListInsertBefore(&list->sentinel, hook);
+}
+
+void intrusiveListUnlink(ListHook *hook) {
+    if (!listHookIsLinked(hook)) {
+        return;
+    }
+
+    hook->prev->next = hook->next;
+    hook->next->prev = hook->prev;
+    hook->prev = NULL;
+    hook->next = NULL;
+}
+
+ListHook *intrusiveListGetFirst(IntrusiveList *list) {
+    if (list == NULL) {
+        return NULL;
+    }
+    return getItemHook(list, list->sentinel.next);
+}
+
+ListHook *intrusiveListGetLast(IntrusiveList *list) {
+    if (list == NULL) {
+        return NULL;
+    }
+    return getItemHook(list, list->sentinel.prev);
+}
+
+ListHook *intrusiveListGetNext(IntrusiveList *list, ListHook *hook) {
+    if (list == NULL || hook == NULL) {
+        return NULL;
+    }
+    return getItemHook(list, hook->next);
+}
+
+ListHook *intrusiveListGetPrev(IntrusiveList *list, ListHook *hook) {
+    if (list == NULL || hook == NULL) {
+        return NULL;
+    }
+    return getItemHook(list, hook->prev);
+}
@@ -0,0 +1,77 @@
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* An intrusive doubly linked list. Instead of allocating a node for every item, callers embed a ListHook in their
+ * own structs and link those hooks into the list, so linking and unlinking never allocate memory, and the item is
+ * reached from its hook with CONTAINER_OF instead of through a data pointer. The list is circular around a
+ * sentinel hook inside the list itself, so a hook can be unlinked in O(1) without knowing its list.
+ * A hook can be in a single list at a time. The list does not own the items and never frees them */
+
+/* The links embedded in every item of an intrusive list */
+typedef struct ListHook_t {
+    struct ListHook_t *prev;
+    struct ListHook_t *next;
+} ListHook;
+
+/* The list controller object. It is usually embedded in another struct, or lives on the stack */
+typedef struct IntrusiveList_t {
+    ListHook sentinel;
+} IntrusiveList;
+
+/* Returns a pointer to the struct of the given type that has the hook pointed to by hook_pointer as its member */
+#define CONTAINER_OF(hook_pointer, type, member) \
+    ((type *) ((char *) (hook_pointer) - offsetof(type, member)))
+
+
+/* Initializes an empty list. Must be called before any other use of the list */
+void intrusiveListInit(IntrusiveList *list);
+
+/* Initializes a hook that is not in any list */
+void listHookInit(ListHook *hook);
+
+/* Returns whether the hook is currently linked into a list */
+bool listHookIsLinked(ListHook *hook);
+
+/* Returns whether the list has no items, in O(1) */
+bool intrusiveListIsEmpty(IntrusiveList *list);
+
+/* Returns the amount of items in the list. The list does not keep a count (unlinking does not know the list),
+ * so this takes O(n) */
+int intrusiveListGetSize(IntrusiveList *list);
+
+/* Links hook (which is not in any list) right after target_hook, which is in the list */
+void intrusiveListInsertAfter(ListHook *target_hook, ListHook *hook);
+
+/* Links hook (which is not in any list) right before target_hook, which is in the list */
+void intrusiveListInsertBefore(ListHook *target_hook, ListHook *hook);
+
+/* Links hook (which is not in any list) as the first item of the list */
+void intrusiveListInsertStart(IntrusiveList *list, ListHook *hook);
+
+/* Links hook (which is not in any list) as the last item of the list */
+void intrusiveListInsertEnd(IntrusiveList *list, ListHook *hook);
+
+/* Unlinks hook from the list it is in, in O(1). Unlinking a hook that is not linked does nothing */
+void intrusiveListUnlink(ListHook *hook);
+
+/* Returns the first hook of the list, or NULL if the list is empty */
+ListHook *intrusiveListGetFirst(IntrusiveList *list);
+
+/* Returns the last hook of the list, or NULL if the list is empty */
+ListHook *intrusiveListGetLast(IntrusiveList *list);
+
+/* Returns the hook after hook in the list, or NULL if hook is the last one */
+ListHook *intrusiveListGetNext(IntrusiveList *list, ListHook *hook);
+
+/* Returns the hook before hook in the list, or NULL if hook is the first one */
+ListHook *intrusiveListGetPrev(IntrusiveList *list, ListHook *hook);
+
+/* Macro to iterate over all of the list hooks. The current hook may not be unlinked inside the loop */
+#define INTRUSIVE_LIST_FOREACH(list, iter) \
+    for(ListHook *iter = intrusiveListGetFirst(list); iter != NULL; iter = intrusiveListGetNext(list, iter))
+
+
+#endif //INTRUSIVE_LIST_H
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "intrusive_list.h"
+
+#define ITEMS_COUNT 10
+
+typedef struct {
+    int number;
+    ListHook hook;
+} Item;
+
+
+static int getNumber(ListHook *hook) {
+    return CONTAINER_OF(hook, Item, hook)->number;
+}
+
+/* Initializes items with the numbers 0..ITEMS_COUNT-1 and links them to list in order */
+static void linkNumbers(IntrusiveList *list, Item *items) {
+    intrusiveListInit(list);
+    for (int i = 0; i < ITEMS_COUNT; i++) {
+        items[i].number = i;
+        listHookInit(&items[i].hook);
+        intrusiveListInsertEnd(list, &items[i].hook);
+    }
+}
+
+
+/* ============= TESTING intrusiveListInit ============= */
+bool testIntrusiveListInitIsEmpty() {
+    bool result = true;
+    IntrusiveList list;
+    intrusiveListInit(&list);
+    ASSERT_TEST(intrusiveListIsEmpty(&list), destroy);
+    ASSERT_TEST(intrusiveListGetSize(&list) == 0, destroy);
+    ASSERT_TEST(intrusiveListGetFirst(&list) == NULL, destroy);
+    ASSERT_TEST(intrusiveListGetLast(&list) == NULL, destroy);
+
+    destroy:
+    return result;
+}
+
+/* ============= TESTING intrusiveListInsertEnd ============= */
+bool testIntrusiveListKeepsOrderBothWays() {
+    bool result = true;
+    IntrusiveList list;
+    Item items[ITEMS_COUNT];
+    linkNumbers(&list, items);
+    ASSERT_TEST(intrusiveListGetSize(&list) == ITEMS_COUNT, destroy);
+
+    int expected = 0;
+    INTRUSIVE_LIST_FOREACH(&list, hook) {
+        ASSERT_TEST(getNumber(hook) == expected, destroy);
+        expected++;
+    }
+
+    ListHook *hook = intrusiveListGetLast(&list);
+    for (int i = ITEMS_COUNT - 1; i >= 0; i--) {
+        ASSERT_TEST(hook == &items[i].hook, destroy);
+        hook = intrusiveListGetPrev(&list, hook);
+    }
+    ASSERT_TEST(hook == NULL, destroy);
+
+    destroy:
+    return result;
+}
+
+/* ============= TESTING intrusiveListUnlink ============= */
+bool testIntrusiveListUnlinkFromHookAlone() {
+    bool result = true;
+    IntrusiveList list;
+    Item items[ITEMS_COUNT];
+    linkNumbers(&list, items);
+
+    // The first, a middle and the last item are unlinked without the list
+    intrusiveListUnlink(&items[0].hook);
+    intrusiveListUnlink(&items[5].hook);
+    intrusiveListUnlink(&items[ITEMS_COUNT - 1].hook);
+    intrusiveListUnlink(&items[5].hook);
+    ASSERT_TEST(!listHookIsLinked(&items[5].hook), destroy);
+    ASSERT_TEST(intrusiveListGetSize(&list) == ITEMS_COUNT - 3, destroy);
+    ASSERT_TEST(getNumber(intrusiveListGetFirst(&list)) == 1, destroy);
+    ASSERT_TEST(getNumber(intrusiveListGetLast(&list)) == ITEMS_COUNT - 2, destroy);
+    ASSERT_TEST(getNumber(intrusiveListGetNext(&list, &items[4].hook)) == 6, destroy);
+
+    // An unlinked item can be linked again, to this list or another one
+    intrusiveListInsertBefore(&items[6].hook, &items[5].hook);
+    ASSERT_TEST(getNumber(intrusiveListGetNext(&list, &items[4].hook)) == 5, destroy);
+    IntrusiveList other_list;
+    intrusiveListInit(&other_list);
+    intrusiveListInsertStart(&other_list, &items[0].hook);
+    ASSERT_TEST(intrusiveListGetSize(&other_list) == 1, destroy);
+    ASSERT_TEST(intrusiveListGetSize(&list) == ITEMS_COUNT - 2, destroy);
+
+    destroy:
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testIntrusiveListInitIsEmpty,
+        testIntrusiveListKeepsOrderBothWays,
+        testIntrusiveListUnlinkFromHookAlone
+};
+
+const char *testNames[] = {
+        "testIntrusiveListInitIsEmpty",
+        "testIntrusiveListKeepsOrderBothWays",
+        "testIntrusiveListUnlinkFromHookAlone"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testIntrusiveListInitIsEmpty",
+        "Please refer to the testing code at function: testIntrusiveListKeepsOrderBothWays",
+        "Please refer to the testing code at function: testIntrusiveListUnlinkFromHookAlone"
+};
+
+
+#define NUMBER_TESTS 3
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: intrusive_list_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}
@@ -0,0 +1,145 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "double_linked_list.h"
+#include "unrolled_linked_list.h"
+#include "compact_linked_list.h"
+
+/* Compares a full sequential scan (reading every item) of a LinkedList, an UnrolledList and a CompactList of the
+ * same items.
+ * The LinkedList is scanned twice: once as it was built by appending, when its nodes follow each other in its
+ * chunks, and once after its nodes were shuffled by listMoveAfter, as they end up after a long insert/remove
+ * churn, so every step of the scan goes to a different place in memory.
+ * Usage: list_bench [items count] [repeats]
+ */
+
+#define DEFAULT_ITEMS_COUNT (1 << 20)
+#define DEFAULT_REPEATS 5
+#define NANOSECONDS_IN_SECOND 1000000000L
+
+static long getNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NANOSECONDS_IN_SECOND + now.tv_nsec;
+}
+
+/* The items are the numbers 0..items_count-1 stored in the data pointers, so only the list itself is read */
+static NodeData getItem(int number) {
+    return (NodeData) (intptr_t) number;
+}
+
+static long scanLinkedList(LinkedList list) {
+    long sum = 0;
+    LIST_FOREACH(list, node) {
+        sum += (intptr_t) listGetData(node);
+    }
+    return sum;
+}
+
+static long scanCompactList(CompactList list) {
+    long sum = 0;
+    COMPACT_LIST_FOREACH(list, node) {
+        sum += (intptr_t) compactListGetData(list, node);
+    }
+    return sum;
+}
+
+static long scanUnrolledList(UnrolledList list) {
+    long sum = 0;
+    UNROLLED_LIST_FOREACH(list, position) {
+        sum += (intptr_t) unrolledListGetData(position);
+    }
+    return sum;
+}
+
+/* Moves every node after a randomly chosen node, so the order of the list no longer follows its memory */
+static void shuffleLinkedList(LinkedList list, LinkedNode *nodes, int items_count) {
+    for (int i = 0; i < items_count; i++) {
+        LinkedNode target_node = nodes[((unsigned) rand() * (unsigned) RAND_MAX + rand()) % items_count];
+        listMoveAfter(list, nodes[i], target_node);
+    }
+}
+
+/* Runs scan on list repeats times and prints the best time of a single scan */
+static void reportScan(const char *name, long (*scan)(void *), void *list, int items_count, int repeats) {
+    long best_nanoseconds = -1;
+    long sum = 0;
+    for (int i = 0; i < repeats; i++) {
+        long start = getNanoseconds();
+        sum = scan(list);
+        long elapsed = getNanoseconds() - start;
+        if (best_nanoseconds < 0 || elapsed < best_nanoseconds) {
+            best_nanoseconds = elapsed;
+        }
+    }
+    fprintf(stdout, "%-28s %14ld ns %8.2f ns per item (sum %ld)\n", name, best_nanoseconds,
+            (double) best_nanoseconds / items_count, sum);
+}
+
+static long scanLinkedListGeneric(void *list) {
+    return scanLinkedList(list);
+}
+
+static long scanUnrolledListGeneric(void *list) {
+    return scanUnrolledList(list);
+}
+
+static long scanCompactListGeneric(void *list) {
+    return scanCompactList(list);
+}
+
+static void destroyLists(LinkedList linked_list, UnrolledList unrolled_list, CompactList compact_list,
+                         LinkedNode *nodes) {
+    listDestroy(linked_list);
+    unrolledListDestroy(unrolled_list);
+    compactListDestroy(compact_list);
+    free(nodes);
+}
+
+int main(int argc, char **argv) {
+    int items_count = argc > 1 ? strtol(argv[1], NULL, 10) : DEFAULT_ITEMS_COUNT;
+    int repeats = argc > 2 ? strtol(argv[2], NULL, 10) : DEFAULT_REPEATS;
+    if (items_count <= 0 || repeats <= 0) {
+        fprintf(stdout, "Usage: list_bench [items count] [repeats]\n");
+        return 0;
+    }
+
+    LinkedList linked_list = listCreateWithCapacity(items_count);
+    UnrolledList unrolled_list = unrolledListCreate();
+    CompactList compact_list = compactListCreateWithCapacity(items_count);
+    LinkedNode *nodes = malloc(items_count * sizeof(*nodes));
+    if (linked_list == NULL || unrolled_list == NULL || compact_list == NULL || nodes == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        destroyLists(linked_list, unrolled_list, compact_list, nodes);
+        return 1;
+    }
+
+    LinkedNode last_node = NULL;
+    UnrolledPosition last_position = unrolledListGetLast(unrolled_list);
+    for (int i = 0; i < items_count; i++) {
+        last_node = listInsertEnd(linked_list, getItem(i));
+        last_position = unrolledListIsValid(last_position)
+                        ? unrolledListInsertAfter(unrolled_list, last_position, getItem(i))
+                        : unrolledListInsertStart(unrolled_list, getItem(i));
+        if (last_node == NULL || !unrolledListIsValid(last_position) ||
+            compactListInsertEnd(compact_list, getItem(i)) == COMPACT_NULL_NODE) {
+            fprintf(stderr, "Out of memory\n");
+            destroyLists(linked_list, unrolled_list, compact_list, nodes);
+            return 1;
+        }
+        nodes[i] = last_node;
+    }
+
+    fprintf(stdout, "Scanning %d items, best of %d\n", items_count, repeats);
+    reportScan("linked list (appended)", scanLinkedListGeneric, linked_list, items_count, repeats);
+    shuffleLinkedList(linked_list, nodes, items_count);
+    reportScan("linked list (shuffled)", scanLinkedListGeneric, linked_list, items_count, repeats);
+    reportScan("unrolled list", scanUnrolledListGeneric, unrolled_list, items_count, repeats);
+    reportScan("compact list", scanCompactListGeneric, compact_list, items_count, repeats);
+
+    destroyLists(linked_list, unrolled_list, compact_list, nodes);
+    return 0;
+}
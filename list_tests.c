@@ -0,0 +1,418 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include "test_utilities.h"
+#include "double_linked_list.h"
+
+#define ITEMS_COUNT 10
+#define LARGE_LIST_NODES ((int64_t) INT_MAX + 1000)
+
+
+static NodeData getItem(int number) {
+    return (NodeData) (intptr_t) number;
+}
+
+static int getNumber(LinkedNode node) {
+    return (int) (intptr_t) listGetData(node);
+}
+
+/* Creates a list of the numbers 0..ITEMS_COUNT-1 in order */
+LinkedList createNumbersList() {
+    LinkedList list = listCreate();
+    for (int i = 0; i < ITEMS_COUNT; i++) {
+        listInsertEnd(list, getItem(i));
+    }
+    return list;
+}
+
+
+/* ============= TESTING listInsertEnd ============= */
+bool testListInsertEndKeepsOrder() {
+    bool result = true;
+    LinkedList list = createNumbersList();
+    ASSERT_TEST(listGetSize(list) == ITEMS_COUNT, destroy);
+    ASSERT_TEST(listInsertEnd(NULL, getItem(0)) == NULL, destroy);
+
+    int expected = 0;
+    LIST_FOREACH(list, node) {
+        ASSERT_TEST(getNumber(node) == expected, destroy);
+        expected++;
+    }
+    ASSERT_TEST(getNumber(listGetLast(list)) == ITEMS_COUNT - 1, destroy);
+
+    destroy:
+    listDestroy(list);
+    return result;
+}
+
+/* ============= TESTING LIST_FOREACH_REVERSE ============= */
+bool testListForEachReverse() {
+    bool result = true;
+    LinkedList list = createNumbersList();
+
+    int expected = ITEMS_COUNT - 1;
+    LIST_FOREACH_REVERSE(list, node) {
+        ASSERT_TEST(getNumber(node) == expected, destroy);
+        expected--;
+    }
+    ASSERT_TEST(expected == -1, destroy);
+
+    destroy:
+    listDestroy(list);
+    return result;
+}
+
+/* ============= TESTING listInsertBefore / listRemoveLast ============= */
+bool testListInsertBeforeAndRemoveLast() {
+    bool result = true;
+    LinkedList list = listCreate();
+    LinkedNode middle_node = listInsertEnd(list, getItem(2));
+    ASSERT_TEST(listInsertBefore(list, NULL, getItem(0)) == NULL, destroy);
+    ASSERT_TEST(listInsertBefore(list, middle_node, getItem(0)) == listGetFirst(list), destroy);
+    ASSERT_TEST(listInsertBefore(list, middle_node, getItem(1)) != NULL, destroy);
+    ASSERT_TEST(listInsertEnd(list, getItem(3)) == listGetLast(list), destroy);
+
+    int expected = 0;
+    LIST_FOREACH(list, node) {
+        ASSERT_TEST(getNumber(node) == expected, destroy);
+        expected++;
+    }
+
+    for (int i = 3; i >= 0; i--) {
+        ASSERT_TEST(getNumber(listGetLast(list)) == i, destroy);
+        listRemoveLast(list);
+    }
+    ASSERT_TEST(listGetSize(list) == 0, destroy);
+    ASSERT_TEST(listGetFirst(list) == NULL && listGetLast(list) == NULL, destroy);
+    ASSERT_TEST(listRemoveLast(list) == NULL, destroy);
+
+    destroy:
+    listDestroy(list);
+    return result;
+}
+
+
+/* Returns whether list holds exactly the numbers in expected, in order, and its size matches */
+static bool hasNumbers(LinkedList list, const int *expected, int expected_count) {
+    if (listGetSize(list) != expected_count) {
+        return false;
+    }
+    int index = 0;
+    LIST_FOREACH(list, node) {
+        if (index >= expected_count || getNumber(node) != expected[index]) {
+            return false;
+        }
+        index++;
+    }
+    index = expected_count - 1;
+    LIST_FOREACH_REVERSE(list, node) {
+        if (getNumber(node) != expected[index]) {
+            return false;
+        }
+        index--;
+    }
+    return true;
+}
+
+/* ============= TESTING listSpliceAfter ============= */
+static void *allocateCounting(size_t size, void *context) {
+    (*(int *) context)++;
+    return malloc(size);
+}
+
+static void deallocateCounting(void *memory, void *context) {
+    (*(int *) context)--;
+    free(memory);
+}
+
+bool testListSpliceAfterMovesRangeBetweenLists() {
+    bool result = true;
+    LinkedList list = createNumbersList();
+    LinkedList other_list = listCreate();
+    LinkedList counting_list = NULL;
+    int live_allocations = 0;
+    LinkedNode other_node = listInsertEnd(other_list, getItem(100));
+    listInsertEnd(other_list, getItem(101));
+
+    // Moves 3..5 after 100
+    LinkedNode first_node = listGetNext(listGetNext(listGetNext(listGetFirst(list))));
+    LinkedNode last_node = listGetNext(listGetNext(first_node));
+    ASSERT_TEST(listSpliceAfter(other_list, other_node, list, first_node, last_node), destroy);
+    int expected_list[] = {0, 1, 2, 6, 7, 8, 9};
+    int expected_other_list[] = {100, 3, 4, 5, 101};
+    ASSERT_TEST(hasNumbers(list, expected_list, 7), destroy);
+    ASSERT_TEST(hasNumbers(other_list, expected_other_list, 5), destroy);
+
+    // The moved nodes outlive the list they were allocated by
+    listDestroy(list);
+    list = NULL;
+    ASSERT_TEST(listInsertStart(other_list, getItem(99)) != NULL, destroy);
+    listRemoveLast(other_list);
+    int expected_after_destroy[] = {99, 100, 3, 4, 5};
+    ASSERT_TEST(hasNumbers(other_list, expected_after_destroy, 5), destroy);
+
+    // A list with another allocator cannot share memory, so the nodes are moved one by one
+    counting_list = listCreateWithAllocator(allocateCounting, deallocateCounting, &live_allocations);
+    listInsertEnd(counting_list, getItem(200));
+    ASSERT_TEST(listSpliceAfter(counting_list, listGetFirst(counting_list), other_list,
+                                listGetNext(listGetFirst(other_list)), listGetLast(other_list)), destroy);
+    int expected_counting_list[] = {200, 100, 3, 4, 5};
+    int expected_other_after_move[] = {99};
+    ASSERT_TEST(hasNumbers(counting_list, expected_counting_list, 5), destroy);
+    ASSERT_TEST(hasNumbers(other_list, expected_other_after_move, 1), destroy);
+    listDestroy(other_list);
+    other_list = NULL;
+    ASSERT_TEST(hasNumbers(counting_list, expected_counting_list, 5), destroy);
+    listDestroy(counting_list);
+    counting_list = NULL;
+    ASSERT_TEST(live_allocations == 0, destroy);
+
+    destroy:
+    listDestroy(list);
+    listDestroy(other_list);
+    listDestroy(counting_list);
+    return result;
+}
+
+/* ============= TESTING listConcat / listSplitAfter ============= */
+bool testListConcatAndSplitAfter() {
+    bool result = true;
+    LinkedList list = createNumbersList();
+    LinkedList other_list = createNumbersList();
+    LinkedList split_list = NULL;
+    LinkedList third_list = NULL;
+    LinkedList fourth_list = NULL;
+
+    ASSERT_TEST(listConcat(list, other_list), destroy);
+    ASSERT_TEST(listGetSize(list) == 2 * ITEMS_COUNT && listGetSize(other_list) == 0, destroy);
+    ASSERT_TEST(listGetFirst(other_list) == NULL && listGetLast(other_list) == NULL, destroy);
+
+    // Splits after the last node of the first half
+    LinkedNode node = listGetFirst(list);
+    for (int i = 1; i < ITEMS_COUNT; i++) {
+        node = listGetNext(node);
+    }
+    split_list = listSplitAfter(list, node);
+    ASSERT_TEST(split_list != NULL, destroy);
+    int expected[ITEMS_COUNT];
+    for (int i = 0; i < ITEMS_COUNT; i++) {
+        expected[i] = i;
+    }
+    ASSERT_TEST(hasNumbers(list, expected, ITEMS_COUNT), destroy);
+    ASSERT_TEST(hasNumbers(split_list, expected, ITEMS_COUNT), destroy);
+
+    // Two lists that both share their memory with other lists are joined by moving the nodes one by one
+    third_list = createNumbersList();
+    fourth_list = listSplitAfter(third_list, listGetFirst(third_list));
+    ASSERT_TEST(listConcat(list, fourth_list), destroy);
+    ASSERT_TEST(listGetSize(list) == 2 * ITEMS_COUNT - 1 && listGetSize(fourth_list) == 0, destroy);
+    ASSERT_TEST(listGetFirst(fourth_list) == NULL && listGetLast(fourth_list) == NULL, destroy);
+    listDestroy(third_list);
+    third_list = NULL;
+    listDestroy(fourth_list);
+    fourth_list = NULL;
+    int expected_joined[2 * ITEMS_COUNT - 1];
+    for (int i = 0; i < 2 * ITEMS_COUNT - 1; i++) {
+        expected_joined[i] = i < ITEMS_COUNT ? i : i - ITEMS_COUNT + 1;
+    }
+    ASSERT_TEST(hasNumbers(list, expected_joined, 2 * ITEMS_COUNT - 1), destroy);
+
+    destroy:
+    listDestroy(list);
+    listDestroy(other_list);
+    listDestroy(split_list);
+    listDestroy(third_list);
+    listDestroy(fourth_list);
+    return result;
+}
+
+
+typedef struct {
+    int key;
+    int order;
+} KeyedItem;
+
+static int compareKeys(NodeData first, NodeData second) {
+    return ((KeyedItem *) first)->key - ((KeyedItem *) second)->key;
+}
+
+/* Returns whether the items of list are sorted by key, and by order between equal keys */
+static bool isSortedStably(LinkedList list) {
+    KeyedItem *prev_item = NULL;
+    LIST_FOREACH(list, node) {
+        KeyedItem *item = listGetData(node);
+        if (prev_item != NULL && (prev_item->key > item->key ||
+                                  (prev_item->key == item->key && prev_item->order > item->order))) {
+            return false;
+        }
+        prev_item = item;
+    }
+    return prev_item == listGetData(listGetLast(list));
+}
+
+/* ============= TESTING listSort ============= */
+bool testListSortIsStable() {
+    bool result = true;
+    LinkedList list = listCreate();
+    KeyedItem items[101];
+    for (int i = 0; i < 101; i++) {
+        items[i].key = (i * 37) % 10;
+        items[i].order = i;
+        listInsertEnd(list, &items[i]);
+    }
+
+    listSort(list, compareKeys);
+    ASSERT_TEST(listGetSize(list) == 101, destroy);
+    ASSERT_TEST(isSortedStably(list), destroy);
+    int count = 0;
+    LIST_FOREACH_REVERSE(list, node) {
+        count++;
+    }
+    ASSERT_TEST(count == 101, destroy);
+
+    destroy:
+    listDestroy(list);
+    return result;
+}
+
+/* ============= TESTING listMergeSorted ============= */
+bool testListMergeSortedKeepsListNodesFirst() {
+    bool result = true;
+    LinkedList list = listCreate();
+    LinkedList other_list = listCreate();
+    KeyedItem items[20];
+    for (int i = 0; i < 20; i++) {
+        // The first list gets the even keys 0, 2, ..., and the second one 0, 3, 6, ..., after it in order
+        items[i].key = i < 10 ? i * 2 : (i - 10) * 3;
+        items[i].order = i;
+        listInsertEnd(i < 10 ? list : other_list, &items[i]);
+    }
+
+    ASSERT_TEST(listMergeSorted(list, other_list, compareKeys), destroy);
+    ASSERT_TEST(listGetSize(list) == 20 && listGetSize(other_list) == 0, destroy);
+    ASSERT_TEST(isSortedStably(list), destroy);
+    ASSERT_TEST(!listMergeSorted(list, list, compareKeys), destroy);
+
+    destroy:
+    listDestroy(list);
+    listDestroy(other_list);
+    return result;
+}
+
+/* ============= TESTING listGetSize64 ============= */
+bool testListGetSize64MatchesGetSize() {
+    bool result = true;
+    LinkedList list = createNumbersList();
+    LinkedList other_list = createNumbersList();
+    ASSERT_TEST(listGetSize64(NULL) == -1, destroy);
+    ASSERT_TEST(listGetSize64(list) == ITEMS_COUNT, destroy);
+    ASSERT_TEST(listConcat(list, other_list), destroy);
+    ASSERT_TEST(listGetSize64(list) == 2 * ITEMS_COUNT && listGetSize64(other_list) == 0, destroy);
+    listRemoveFirst(list);
+    listRemoveLast(list);
+    ASSERT_TEST(listGetSize64(list) == listGetSize(list) && listGetSize(list) == 2 * ITEMS_COUNT - 2, destroy);
+    ASSERT_TEST(!listReserve64(list, -1), destroy);
+    ASSERT_TEST(listReserve64(list, 4 * ITEMS_COUNT), destroy);
+
+    destroy:
+    listDestroy(list);
+    listDestroy(other_list);
+    return result;
+}
+
+/* Builds and drains a list of more than INT_MAX nodes, reserved in a single chunk (24 bytes per node on 64-bit
+ * machines, about 52GB in total). It only runs when the LIST_LARGE_TEST environment variable is set: to the
+ * amount of nodes, or to 1 for LARGE_LIST_NODES */
+bool testListBeyondIntMaxNodes() {
+    const char *nodes_count_text = getenv("LIST_LARGE_TEST");
+    if (nodes_count_text == NULL) {
+        return true;
+    }
+    int64_t nodes_count = strtoll(nodes_count_text, NULL, 10);
+    if (nodes_count <= 1) {
+        nodes_count = LARGE_LIST_NODES;
+    }
+
+    bool result = true;
+    LinkedList list = listCreate();
+    ASSERT_TEST(listReserve64(list, nodes_count), destroy);
+    for (int64_t i = 0; i < nodes_count; i++) {
+        ASSERT_TEST(listInsertEnd(list, (NodeData) (intptr_t) i) != NULL, destroy);
+    }
+    ASSERT_TEST(listGetSize64(list) == nodes_count, destroy);
+    ASSERT_TEST(listGetSize(list) == (nodes_count < INT_MAX ? (int) nodes_count : INT_MAX), destroy);
+    ASSERT_TEST((intptr_t) listGetData(listGetLast(list)) == nodes_count - 1, destroy);
+
+    for (int64_t i = 0; i < nodes_count; i++) {
+        ASSERT_TEST((intptr_t) listGetData(listGetFirst(list)) == i, destroy);
+        listRemoveFirst(list);
+    }
+    ASSERT_TEST(listGetSize64(list) == 0 && listGetFirst(list) == NULL, destroy);
+
+    destroy:
+    listDestroy(list);
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testListInsertEndKeepsOrder,
+        testListForEachReverse,
+        testListInsertBeforeAndRemoveLast,
+        testListSpliceAfterMovesRangeBetweenLists,
+        testListConcatAndSplitAfter,
+        testListSortIsStable,
+        testListMergeSortedKeepsListNodesFirst,
+        testListGetSize64MatchesGetSize,
+        testListBeyondIntMaxNodes
+};
+
+const char *testNames[] = {
+        "testListInsertEndKeepsOrder",
+        "testListForEachReverse",
+        "testListInsertBeforeAndRemoveLast",
+        "testListSpliceAfterMovesRangeBetweenLists",
+        "testListConcatAndSplitAfter",
+        "testListSortIsStable",
+        "testListMergeSortedKeepsListNodesFirst",
+        "testListGetSize64MatchesGetSize",
+        "testListBeyondIntMaxNodes"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testListInsertEndKeepsOrder",
+        "Please refer to the testing code at function: testListForEachReverse",
+        "Please refer to the testing code at function: testListInsertBeforeAndRemoveLast",
+        "Please refer to the testing code at function: testListSpliceAfterMovesRangeBetweenLists",
+        "Please refer to the testing code at function: testListConcatAndSplitAfter",
+        "Please refer to the testing code at function: testListSortIsStable",
+        "Please refer to the testing code at function: testListMergeSortedKeepsListNodesFirst",
+        "Please refer to the testing code at function: testListGetSize64MatchesGetSize",
+        "Please refer to the testing code at function: testListBeyondIntMaxNodes"
+};
+
+
+#define NUMBER_TESTS 9
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: linked_list_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}
@@ -0,0 +1,230 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "double_linked_list.h"
+#include "lock_free_list.h"
+
+/* Compares the throughput of a LockFreeList and of an ordered LinkedList behind a single mutex, used as the same
+ * set of numbers by a growing amount of threads (1, 2, 4, ... up to the given threads count).
+ * Every thread runs a mix of 10% inserts, 10% removes and 80% lookups of random keys in [0, key range), on a set
+ * that starts with half of the keys. The last round runs exactly the given threads count, even if it is not a
+ * power of 2.
+ * Usage: lock_free_bench [threads count] [operations per thread] [key range]
+ */
+
+#define DEFAULT_THREADS_COUNT 4
+#define DEFAULT_OPERATIONS_COUNT 200000
+#define DEFAULT_KEY_RANGE 1024
+#define NANOSECONDS_IN_SECOND 1000000000L
+
+typedef enum {
+    OPERATION_INSERT,
+    OPERATION_REMOVE,
+    OPERATION_CONTAINS
+} Operation;
+
+/* An ordered LinkedList used as a set, with a mutex around every operation */
+typedef struct {
+    LinkedList list;
+    pthread_mutex_t mutex;
+} LockedList;
+
+typedef struct {
+    LockFreeList lock_free_list;
+    LockedList *locked_list;
+    int operations_count;
+    int key_range;
+    unsigned int seed;
+} WorkerArgs;
+
+static long getNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NANOSECONDS_IN_SECOND + now.tv_nsec;
+}
+
+static NodeData getItem(int number) {
+    return (NodeData) (intptr_t) number;
+}
+
+static int compareItems(NodeData first, NodeData second) {
+    intptr_t first_number = (intptr_t) first;
+    intptr_t second_number = (intptr_t) second;
+    return (first_number > second_number) - (first_number < second_number);
+}
+
+/* Returns the next random key of the worker and the operation to do with it */
+static int getNextKey(WorkerArgs *args, Operation *operation) {
+    args->seed ^= args->seed << 13;
+    args->seed ^= args->seed >> 17;
+    args->seed ^= args->seed << 5;
+    unsigned int percent = (args->seed >> 24) % 100;
+    *operation = percent < 10 ? OPERATION_INSERT : percent < 20 ? OPERATION_REMOVE : OPERATION_CONTAINS;
+    return (int) (args->seed % (unsigned int) args->key_range);
+}
+
+/* Runs operation on the locked list. The list is kept sorted, so a lookup stops at the first key not smaller */
+static void runLockedOperation(LockedList *locked_list, Operation operation, int key) {
+    pthread_mutex_lock(&locked_list->mutex);
+    LinkedNode previous_node = NULL;
+    LinkedNode node = listGetFirst(locked_list->list);
+    while (node != NULL && (intptr_t) listGetData(node) < key) {
+        previous_node = node;
+        node = listGetNext(node);
+    }
+    bool is_found = node != NULL && (intptr_t) listGetData(node) == key;
+    if (operation == OPERATION_INSERT && !is_found) {
+        if (previous_node == NULL) {
+            listInsertStart(locked_list->list, getItem(key));
+        } else {
+            listInsertAfter(locked_list->list, previous_node, getItem(key));
+        }
+    } else if (operation == OPERATION_REMOVE && is_found) {
+        listRemove(locked_list->list, node);
+    }
+    pthread_mutex_unlock(&locked_list->mutex);
+}
+
+static void *runLockedWorker(void *argument) {
+    WorkerArgs *args = argument;
+    for (int i = 0; i < args->operations_count; i++) {
+        Operation operation;
+        int key = getNextKey(args, &operation);
+        runLockedOperation(args->locked_list, operation, key);
+    }
+    return NULL;
+}
+
+static void *runLockFreeWorker(void *argument) {
+    WorkerArgs *args = argument;
+    LockFreeThread thread = lockFreeListRegisterThread(args->lock_free_list);
+    for (int i = 0; thread != NULL && i < args->operations_count; i++) {
+        Operation operation;
+        int key = getNextKey(args, &operation);
+        if (operation == OPERATION_INSERT) {
+            lockFreeListInsert(thread, getItem(key));
+        } else if (operation == OPERATION_REMOVE) {
+            lockFreeListRemove(thread, getItem(key));
+        } else {
+            lockFreeListContains(thread, getItem(key));
+        }
+    }
+    lockFreeListUnregisterThread(thread);
+    return NULL;
+}
+
+/* Runs worker on threads_count threads and returns the elapsed nanoseconds, or -1 if a thread failed to start */
+static long runWorkers(void *(*worker)(void *), WorkerArgs *args, int threads_count) {
+    pthread_t *threads = malloc(threads_count * sizeof(*threads));
+    if (threads == NULL) {
+        return -1;
+    }
+
+    long start = getNanoseconds();
+    int started_count = 0;
+    while (started_count < threads_count &&
+           pthread_create(&threads[started_count], NULL, worker, &args[started_count]) == 0) {
+        started_count++;
+    }
+    for (int i = 0; i < started_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    long elapsed = getNanoseconds() - start;
+
+    free(threads);
+    return started_count == threads_count ? elapsed : -1;
+}
+
+static void reportThroughput(const char *name, int threads_count, long nanoseconds, long operations_count) {
+    if (nanoseconds < 0) {
+        fprintf(stderr, "%s: failed to start %d threads\n", name, threads_count);
+        return;
+    }
+    fprintf(stdout, "%-20s %3d threads %14ld ns %10.2f Mops/s\n", name, threads_count, nanoseconds,
+            operations_count * 1000.0 / nanoseconds);
+}
+
+/* Runs both lists with threads_count threads, on lists that start with the even keys */
+static bool runRound(int threads_count, int operations_count, int key_range) {
+    LockedList locked_list = {listCreateWithCapacity(key_range), PTHREAD_MUTEX_INITIALIZER};
+    LockFreeList lock_free_list = lockFreeListCreate(compareItems, NULL);
+    LockFreeThread main_thread = lockFreeListRegisterThread(lock_free_list);
+    WorkerArgs *args = malloc(threads_count * sizeof(*args));
+    bool is_ready = locked_list.list != NULL && main_thread != NULL && args != NULL;
+    for (int key = 0; is_ready && key < key_range; key += 2) {
+        is_ready = listInsertEnd(locked_list.list, getItem(key)) != NULL &&
+                   lockFreeListInsert(main_thread, getItem(key));
+    }
+    lockFreeListUnregisterThread(main_thread);
+
+    if (is_ready) {
+        long total_operations = (long) threads_count * operations_count;
+        for (int i = 0; i < threads_count; i++) {
+            args[i] = (WorkerArgs) {lock_free_list, &locked_list, operations_count, key_range, 2654435761u * (i + 1)};
+        }
+        reportThroughput("mutex linked list", threads_count, runWorkers(runLockedWorker, args, threads_count),
+                         total_operations);
+
+        for (int i = 0; i < threads_count; i++) {
+            args[i] = (WorkerArgs) {lock_free_list, &locked_list, operations_count, key_range, 2654435761u * (i + 1)};
+        }
+        reportThroughput("lock-free list", threads_count, runWorkers(runLockFreeWorker, args, threads_count),
+                         total_operations);
+    }
+
+    free(args);
+    lockFreeListDestroy(lock_free_list);
+    listDestroy(locked_list.list);
+    pthread_mutex_destroy(&locked_list.mutex);
+    return is_ready;
+}
+
+/* Reads the command line argument at index as a positive int to count, or sets count to default_count if there
+ * is no such argument. Returns false if the argument is not a positive int */
+static bool parseCount(int argc, char **argv, int index, int default_count, int *count) {
+    if (argc <= index) {
+        *count = default_count;
+        return true;
+    }
+
+    char *end;
+    errno = 0;
+    long value = strtol(argv[index], &end, 10);
+    if (errno != 0 || end == argv[index] || *end != '\0' || value <= 0 || value > INT_MAX) {
+        return false;
+    }
+    *count = (int) value;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int threads_count;
+    int operations_count;
+    int key_range;
+    if (argc > 4 || !parseCount(argc, argv, 1, DEFAULT_THREADS_COUNT, &threads_count) ||
+        !parseCount(argc, argv, 2, DEFAULT_OPERATIONS_COUNT, &operations_count) ||
+        !parseCount(argc, argv, 3, DEFAULT_KEY_RANGE, &key_range)) {
+        fprintf(stdout, "Usage: lock_free_bench [threads count] [operations per thread] [key range]\n");
+        return 0;
+    }
+
+    fprintf(stdout, "%d operations per thread, %d keys (10%% insert, 10%% remove, 80%% contains)\n",
+            operations_count, key_range);
+    int round_threads_count = 1;
+    while (true) {
+        if (!runRound(round_threads_count, operations_count, key_range)) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        if (round_threads_count == threads_count) {
+            return 0;
+        }
+        round_threads_count = round_threads_count <= threads_count / 2 ? round_threads_count * 2 : threads_count;
+    }
+}
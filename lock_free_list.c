@@ -0,0 +1,374 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include "lock_free_list.h"
+
+#define MARK_BIT ((uintptr_t) 1)
+#define EPOCH_BAGS_COUNT 3
+#define RETIRES_PER_EPOCH_ADVANCE 64
+
+/* A node of the list. The low bit of next marks that the node was removed (nodes are at least pointer aligned).
+ * Once the node is unlinked, it waits in the retired nodes of the thread that unlinked it, linked by next_retired */
+typedef struct lockFreeNode {
+    NodeData data;
+    _Atomic(uintptr_t) next;
+    struct lockFreeNode *next_retired;
+} *LockFreeNode;
+
+/* The state of a thread that uses the list. epoch is the global epoch the thread saw when it entered its current
+ * critical section. A node unlinked by the thread in its epoch e is kept in retired_nodes[e % EPOCH_BAGS_COUNT]
+ * until the thread enters a critical section in epoch e + EPOCH_BAGS_COUNT, since the global epoch can only get
+ * there once every thread that was in a critical section in epoch e left it.
+ * Records stay in the registry until the list is destroyed, and a record whose thread unregistered (is_registered
+ * is false) is taken over by the next thread that registers, along with the nodes still waiting in its bags */
+struct lockFreeThread {
+    LockFreeList list;
+    atomic_ulong epoch;
+    atomic_bool is_active;
+    atomic_bool is_registered;
+    int critical_section_depth;
+    unsigned long last_epoch;
+    LockFreeNode retired_nodes[EPOCH_BAGS_COUNT];
+    int retired_since_advance;
+    struct lockFreeThread *next_thread;
+};
+
+struct lockFreeList {
+    _Atomic(uintptr_t) head;
+    CompareNodeData compare;
+    FreeNodeData free_data;
+    atomic_ulong global_epoch;
+    _Atomic(LockFreeThread) threads;
+};
+
+static LockFreeNode getNode(uintptr_t link) {
+    return (LockFreeNode) (link & ~MARK_BIT);
+}
+
+static bool isMarked(uintptr_t link) {
+    return (link & MARK_BIT) != 0;
+}
+
+static void destroyNode(LockFreeList list, LockFreeNode node) {
+    if (list->free_data != NULL) {
+        list->free_data(node->data);
+    }
+    free(node);
+}
+
+/* Frees a chain of retired nodes */
+static void destroyRetiredNodes(LockFreeList list, LockFreeNode node) {
+    while (node != NULL) {
+        LockFreeNode next_node = node->next_retired;
+        destroyNode(list, node);
+        node = next_node;
+    }
+}
+
+/* Moves the global epoch forward if every thread in a critical section already saw the current one */
+static void tryAdvanceEpoch(LockFreeList list) {
+    unsigned long epoch = atomic_load(&list->global_epoch);
+    for (LockFreeThread thread = atomic_load(&list->threads); thread != NULL; thread = thread->next_thread) {
+        if (atomic_load(&thread->is_active) && atomic_load(&thread->epoch) != epoch) {
+            return;
+        }
+    }
+    atomic_compare_exchange_strong(&list->global_epoch, &epoch, epoch + 1);
+}
+
+/* Enters a critical section of the thread, during which no node it can reach is freed. Critical sections may be
+ * nested (for example when lockFreeListForEach visits call the list) */
+static void enterCriticalSection(LockFreeThread thread) {
+    thread->critical_section_depth++;
+    if (thread->critical_section_depth > 1) {
+        return;
+    }
+
+    // The thread is marked active before it reads the epoch, so an advancing thread either sees it active (with
+    // an older epoch, which blocks the advance) or the thread reads the advanced epoch
+    atomic_store(&thread->is_active, true);
+    unsigned long epoch = atomic_load(&thread->list->global_epoch);
+    atomic_store(&thread->epoch, epoch);
+
+    if (epoch != thread->last_epoch) {
+        LockFreeNode *bag = &thread->retired_nodes[epoch % EPOCH_BAGS_COUNT];
+        destroyRetiredNodes(thread->list, *bag);
+        *bag = NULL;
+        thread->last_epoch = epoch;
+    }
+}
+
+static void exitCriticalSection(LockFreeThread thread) {
+    thread->critical_section_depth--;
+    if (thread->critical_section_depth == 0) {
+        atomic_store(&thread->is_active, false);
+    }
+}
+
+/* Hands a node that the thread unlinked to the epoch reclamation */
+static void retireNode(LockFreeThread thread, LockFreeNode node) {
+    LockFreeNode *bag = &thread->retired_nodes[atomic_load(&thread->epoch) % EPOCH_BAGS_COUNT];
+    node->next_retired = *bag;
+    *bag = node;
+
+    thread->retired_since_advance++;
+    if (thread->retired_since_advance >= RETIRES_PER_EPOCH_ADVANCE) {
+        thread->retired_since_advance = 0;
+        tryAdvanceEpoch(thread->list);
+    }
+}
+
+/* Finds the first node whose data is not smaller than data, and the link pointing to it (the list's head or the
+ * next of the node before it). Marked nodes on the way are unlinked and retired, and if another thread changes
+ * a link under the search, it starts over. Returns whether the found node's data is equal to data.
+ * Must be called inside a critical section */
+static bool findNode(LockFreeThread thread, NodeData data, _Atomic(uintptr_t) **previous_link,
+                     LockFreeNode *current_node) {
+    LockFreeList list = thread->list;
+    while (true) {
+        _Atomic(uintptr_t) *link = &list->head;
+        LockFreeNode node = getNode(atomic_load(link));
+        bool is_restarted = false;
+
+        while (node != NULL) {
+            uintptr_t next = atomic_load(&node->next);
+            if (isMarked(next)) {
+                uintptr_t expected = (uintptr_t) node;
+                if (!atomic_compare_exchange_strong(link, &expected, (uintptr_t) getNode(next))) {
+                    is_restarted = true;
+                    break;
+                }
+                retireNode(thread, node);
+                node = getNode(next);
+                continue;
+            }
+
+            int comparison = list->compare(node->data, data);
+            if (comparison >= 0) {
+                *previous_link = link;
+                *current_node = node;
+                return comparison == 0;
+            }
+            link = &node->next;
+            node = getNode(next);
+        }
+
+        if (!is_restarted) {
+            *previous_link = link;
+            *current_node = NULL;
+            return false;
+        }
+    }
+}
+
+
+LockFreeList lockFreeListCreate(CompareNodeData compare, FreeNodeData free_data) {
+    if (compare == NULL) {
+        return NULL;
+    }
+
+    LockFreeList list = malloc(sizeof(*list));
+    if (list == NULL) {
+        return NULL;
+    }
+
+    atomic_init(&list->head, (uintptr_t) NULL);
+    list->compare = compare;
+    list->free_data = free_data;
+    atomic_init(&list->global_epoch, 0);
+    atomic_init(&list->threads, NULL);
+    return list;
+}
+
+void lockFreeListDestroy(LockFreeList list) {
+    if (list == NULL) {
+        return;
+    }
+
+    LockFreeNode node = getNode(atomic_load(&list->head));
+    while (node != NULL) {
+        LockFreeNode next_node = getNode(atomic_load(&node->next));
+        destroyNode(list, node);
+        node = next_node;
+    }
+
+    LockFreeThread thread = atomic_load(&list->threads);
+    while (thread != NULL) {
+        LockFreeThread next_thread = thread->next_thread;
+        for (int i = 0; i < EPOCH_BAGS_COUNT; i++) {
+            destroyRetiredNodes(list, thread->retired_nodes[i]);
+        }
+        free(thread);
+        thread = next_thread;
+    }
+    free(list);
+}
+
+LockFreeThread lockFreeListRegisterThread(LockFreeList list) {
+    if (list == NULL) {
+        return NULL;
+    }
+
+    for (LockFreeThread thread = atomic_load(&list->threads); thread != NULL; thread = thread->next_thread) {
+        bool is_registered = false;
+        if (atomic_compare_exchange_strong(&thread->is_registered, &is_registered, true)) {
+            return thread;
+        }
+    }
+
+    LockFreeThread thread = malloc(sizeof(*thread));
+    if (thread == NULL) {
+        return NULL;
+    }
+
+    thread->list = list;
+    atomic_init(&thread->epoch, 0);
+    atomic_init(&thread->is_active, false);
+    atomic_init(&thread->is_registered, true);
+    thread->critical_section_depth = 0;
+    thread->last_epoch = 0;
+    for (int i = 0; i < EPOCH_BAGS_COUNT; i++) {
+        thread->retired_nodes[i] = NULL;
+    }
+    thread->retired_since_advance = 0;
+
+    // Threads are only ever pushed to the start of the registry, so readers can walk it without a lock
+    thread->next_thread = atomic_load(&list->threads);
+    while (!atomic_compare_exchange_weak(&list->threads, &thread->next_thread, thread)) {
+    }
+    return thread;
+}
+
+void lockFreeListUnregisterThread(LockFreeThread thread) {
+    if (thread == NULL) {
+        return;
+    }
+    thread->critical_section_depth = 0;
+    atomic_store(&thread->is_active, false);
+    // Published last, so the thread that takes the record over sees its bags as this thread left them
+    atomic_store(&thread->is_registered, false);
+}
+
+bool lockFreeListInsert(LockFreeThread thread, NodeData data) {
+    if (thread == NULL) {
+        return false;
+    }
+
+    LockFreeNode new_node = malloc(sizeof(*new_node));
+    if (new_node == NULL) {
+        return false;
+    }
+    new_node->data = data;
+    new_node->next_retired = NULL;
+
+    enterCriticalSection(thread);
+    bool is_inserted = false;
+    while (true) {
+        _Atomic(uintptr_t) *link;
+        LockFreeNode node;
+        if (findNode(thread, data, &link, &node)) {
+            break;
+        }
+
+        atomic_init(&new_node->next, (uintptr_t) node);
+        uintptr_t expected = (uintptr_t) node;
+        if (atomic_compare_exchange_strong(link, &expected, (uintptr_t) new_node)) {
+            is_inserted = true;
+            break;
+        }
+    }
+    exitCriticalSection(thread);
+
+    if (!is_inserted) {
+        free(new_node);
+    }
+    return is_inserted;
+}
+
+bool lockFreeListRemove(LockFreeThread thread, NodeData data) {
+    if (thread == NULL) {
+        return false;
+    }
+
+    enterCriticalSection(thread);
+    bool is_removed = false;
+    while (true) {
+        _Atomic(uintptr_t) *link;
+        LockFreeNode node;
+        if (!findNode(thread, data, &link, &node)) {
+            break;
+        }
+
+        // Marking the node is the removal itself. If another thread marked it first, the next search unlinks it
+        uintptr_t next = atomic_load(&node->next);
+        if (isMarked(next) || !atomic_compare_exchange_strong(&node->next, &next, next | MARK_BIT)) {
+            continue;
+        }
+        is_removed = true;
+
+        uintptr_t expected = (uintptr_t) node;
+        if (atomic_compare_exchange_strong(link, &expected, next)) {
+            retireNode(thread, node);
+        } else {
+            findNode(thread, data, &link, &node);
+        }
+        break;
+    }
+    exitCriticalSection(thread);
+    return is_removed;
+}
+
+bool lockFreeListContains(LockFreeThread thread, NodeData data) {
+    if (thread == NULL) {
+        return false;
+    }
+
+    enterCriticalSection(thread);
+    LockFreeList list = thread->list;
+    LockFreeNode node = getNode(atomic_load(&list->head));
+    while (node != NULL && list->compare(node->data, data) < 0) {
+        node = getNode(atomic_load(&node->next));
+    }
+    bool is_found = node != NULL && list->compare(node->data, data) == 0 && !isMarked(atomic_load(&node->next));
+    exitCriticalSection(thread);
+    return is_found;
+}
+
+void lockFreeListForEach(LockFreeThread thread, VisitNodeData visit, void *context) {
+    if (thread == NULL || visit == NULL) {
+        return;
+    }
+
+    enterCriticalSection(thread);
+    LockFreeNode node = getNode(atomic_load(&thread->list->head));
+    while (node != NULL) {
+        uintptr_t next = atomic_load(&node->next);
+        if (!isMarked(next)) {
+            visit(node->data, context);
+        }
+        node = getNode(next);
+    }
+    exitCriticalSection(thread);
+}
+
+/* The visit function of lockFreeListGetSize64, context is the count */
+static void countNodeData(NodeData data, void *context) {
+    (void) data;
+    (*(int64_t *) context)++;
+}
+
+int lockFreeListGetSize(LockFreeThread thread) {
+    int64_t size = lockFreeListGetSize64(thread);
+    return size < INT_MAX ? (int) size : INT_MAX;
+}
+
+int64_t lockFreeListGetSize64(LockFreeThread thread) {
+    if (thread == NULL) {
+        return -1;
+    }
+
+    int64_t size = 0;
+    lockFreeListForEach(thread, countNodeData, &size);
+    return size;
+}
@@ -0,0 +1,72 @@
+#ifndef LOCK_FREE_LIST_H
+#define LOCK_FREE_LIST_H
+
+#include <stdbool.h>
+#include "double_linked_list.h"
+
+/* A lock-free ordered set for many threads, which insert, remove and look up items concurrently without any lock.
+ * It is a singly linked list sorted by a compare function (Harris' list, in the form given by Michael): a removed
+ * node is first marked in the low bit of its next pointer, which stops any insertion after it, and is then unlinked
+ * by the remover or by any thread that passes it.
+ * Memory is reclaimed by epochs: every operation runs inside a critical section of the calling thread, and an
+ * unlinked node is freed only after every thread left the critical sections that might still read it.
+ * So every thread that uses the list first registers itself with lockFreeListRegisterThread, and passes the
+ * returned handle to all the other functions. A handle must only be used by the thread that registered it.
+ * Needs a compiler with C11 atomics (stdatomic.h) */
+
+/* Type for defining the list controller object */
+typedef struct lockFreeList *LockFreeList;
+/* Type for defining the handle of a thread that uses the list */
+typedef struct lockFreeThread *LockFreeThread;
+
+/* Type of function for freeing the data of the list's nodes. May be NULL if the list does not own its data */
+typedef void(*FreeNodeData)(NodeData);
+
+/* Type of function called by lockFreeListForEach for every item. context is the value given by the caller */
+typedef void(*VisitNodeData)(NodeData, void *context);
+
+
+/* Creates a new empty list ordered by compare. Items are equal (the same item of the set) if compare returns 0.
+ * free_data (which may be NULL) is called for the data of a removed node once no thread can read it anymore, and
+ * for the data left in the list when it is destroyed. Returns NULL if compare is NULL or allocations failed */
+LockFreeList lockFreeListCreate(CompareNodeData compare, FreeNodeData free_data);
+
+/* Frees the list, its nodes and the handles of all of its threads. No thread may use the list during or after
+ * this call */
+void lockFreeListDestroy(LockFreeList list);
+
+/* Registers the calling thread as a user of the list and returns its handle, or NULL if an allocation failed.
+ * The handle of a thread that unregistered is reused if there is one, so the memory of the registry grows with
+ * the most threads that used the list at once, not with all the threads that ever did.
+ * May be called concurrently with any other function (other than lockFreeListDestroy) */
+LockFreeThread lockFreeListRegisterThread(LockFreeList list);
+
+/* Marks that the thread stopped using the list. Its handle must not be used afterwards. Nodes that the thread
+ * unlinked and were not freed yet are freed by the next thread that gets its handle, or by lockFreeListDestroy */
+void lockFreeListUnregisterThread(LockFreeThread thread);
+
+/* Inserts data to the list in its place by order. Returns false if an equal item is already in the list, or an
+ * allocation failed */
+bool lockFreeListInsert(LockFreeThread thread, NodeData data);
+
+/* Removes the item equal to data from the list. Returns false if there is no such item */
+bool lockFreeListRemove(LockFreeThread thread, NodeData data);
+
+/* Returns whether an item equal to data is in the list */
+bool lockFreeListContains(LockFreeThread thread, NodeData data);
+
+/* Calls visit for every item in the list, in order. The items stay readable during the whole call, even if other
+ * threads remove them. The traversal is not an atomic snapshot: it visits every item that is in the list during
+ * the whole call, and may or may not visit items that are inserted or removed while it runs */
+void lockFreeListForEach(LockFreeThread thread, VisitNodeData visit, void *context);
+
+/* Returns the amount of items in the list, counted like lockFreeListForEach visits them, or INT_MAX if there are
+ * more. Returns -1 if thread is NULL */
+int lockFreeListGetSize(LockFreeThread thread);
+
+/* Returns the amount of items in the list, counted like lockFreeListForEach visits them, which may exceed INT_MAX.
+ * Returns -1 if thread is NULL */
+int64_t lockFreeListGetSize64(LockFreeThread thread);
+
+
+#endif //LOCK_FREE_LIST_H
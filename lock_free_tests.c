@@ -0,0 +1,343 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "test_utilities.h"
+#include "lock_free_list.h"
+
+#define THREADS_COUNT 4
+#define KEYS_PER_THREAD 2000
+#define CONTENDED_KEYS_COUNT 16
+#define CONTENDED_OPERATIONS_COUNT 20000
+#define DEPARTED_ITEMS_COUNT 100
+
+
+/* The items are numbers stored in the data pointers */
+static NodeData getItem(int number) {
+    return (NodeData) (intptr_t) number;
+}
+
+static int compareItems(NodeData first, NodeData second) {
+    intptr_t first_number = (intptr_t) first;
+    intptr_t second_number = (intptr_t) second;
+    return (first_number > second_number) - (first_number < second_number);
+}
+
+/* Checks that the visited items are strictly increasing. context is an OrderCheck */
+typedef struct {
+    intptr_t last_item;
+    int count;
+    bool is_ordered;
+} OrderCheck;
+
+static void checkOrder(NodeData data, void *context) {
+    OrderCheck *check = context;
+    if (check->count > 0 && (intptr_t) data <= check->last_item) {
+        check->is_ordered = false;
+    }
+    check->last_item = (intptr_t) data;
+    check->count++;
+}
+
+static OrderCheck checkListOrder(LockFreeThread thread) {
+    OrderCheck check = {0, 0, true};
+    lockFreeListForEach(thread, checkOrder, &check);
+    return check;
+}
+
+static atomic_int freed_items_count;
+
+static void countFreedItem(NodeData data) {
+    (void) data;
+    atomic_fetch_add(&freed_items_count, 1);
+}
+
+
+/* ============= TESTING single threaded semantics ============= */
+bool testLockFreeListSingleThread() {
+    bool result = true;
+    LockFreeList list = lockFreeListCreate(compareItems, NULL);
+    ASSERT_TEST(lockFreeListCreate(NULL, NULL) == NULL, destroy);
+    ASSERT_TEST(list != NULL, destroy);
+    ASSERT_TEST(lockFreeListRegisterThread(NULL) == NULL, destroy);
+    LockFreeThread thread = lockFreeListRegisterThread(list);
+    ASSERT_TEST(thread != NULL, destroy);
+    ASSERT_TEST(lockFreeListGetSize(NULL) == -1, destroy);
+    ASSERT_TEST(lockFreeListGetSize64(NULL) == -1, destroy);
+    ASSERT_TEST(lockFreeListGetSize(thread) == 0, destroy);
+
+    ASSERT_TEST(lockFreeListInsert(thread, getItem(5)), destroy);
+    ASSERT_TEST(lockFreeListInsert(thread, getItem(1)), destroy);
+    ASSERT_TEST(lockFreeListInsert(thread, getItem(3)), destroy);
+    ASSERT_TEST(!lockFreeListInsert(thread, getItem(3)), destroy);
+    ASSERT_TEST(lockFreeListGetSize(thread) == 3, destroy);
+    ASSERT_TEST(lockFreeListGetSize64(thread) == 3, destroy);
+    OrderCheck check = checkListOrder(thread);
+    ASSERT_TEST(check.is_ordered && check.count == 3 && check.last_item == 5, destroy);
+
+    ASSERT_TEST(lockFreeListContains(thread, getItem(1)), destroy);
+    ASSERT_TEST(!lockFreeListContains(thread, getItem(2)), destroy);
+    ASSERT_TEST(!lockFreeListContains(thread, getItem(6)), destroy);
+    ASSERT_TEST(lockFreeListRemove(thread, getItem(1)), destroy);
+    ASSERT_TEST(!lockFreeListRemove(thread, getItem(1)), destroy);
+    ASSERT_TEST(!lockFreeListContains(thread, getItem(1)), destroy);
+    ASSERT_TEST(lockFreeListRemove(thread, getItem(5)), destroy);
+    ASSERT_TEST(lockFreeListGetSize(thread) == 1, destroy);
+    ASSERT_TEST(lockFreeListInsert(thread, getItem(1)), destroy);
+    check = checkListOrder(thread);
+    ASSERT_TEST(check.is_ordered && check.count == 2 && check.last_item == 3, destroy);
+    lockFreeListUnregisterThread(thread);
+
+    destroy:
+    lockFreeListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING concurrent insert and remove ============= */
+typedef struct {
+    LockFreeList list;
+    int thread_index;
+    atomic_bool *is_writing;
+    bool is_ordered;
+} StressArgs;
+
+/* Inserts all the keys of the thread (the keys equal to the thread's index modulo THREADS_COUNT), then removes
+ * the odd ones among them */
+static void *runWriter(void *argument) {
+    StressArgs *args = argument;
+    LockFreeThread thread = lockFreeListRegisterThread(args->list);
+    args->is_ordered = thread != NULL;
+    for (int i = 0; thread != NULL && i < KEYS_PER_THREAD; i++) {
+        args->is_ordered &= lockFreeListInsert(thread, getItem(i * THREADS_COUNT + args->thread_index));
+    }
+    for (int i = 1; thread != NULL && i < KEYS_PER_THREAD; i += 2) {
+        args->is_ordered &= lockFreeListRemove(thread, getItem(i * THREADS_COUNT + args->thread_index));
+    }
+    lockFreeListUnregisterThread(thread);
+    return NULL;
+}
+
+/* Traverses the list until the writers are done, checking that every traversal sees it ordered */
+static void *runReader(void *argument) {
+    StressArgs *args = argument;
+    LockFreeThread thread = lockFreeListRegisterThread(args->list);
+    args->is_ordered = thread != NULL;
+    while (thread != NULL && atomic_load(args->is_writing)) {
+        args->is_ordered &= checkListOrder(thread).is_ordered;
+    }
+    lockFreeListUnregisterThread(thread);
+    return NULL;
+}
+
+bool testLockFreeListConcurrentInsertRemove() {
+    bool result = true;
+    LockFreeList list = lockFreeListCreate(compareItems, NULL);
+    ASSERT_TEST(list != NULL, destroy);
+
+    atomic_bool is_writing;
+    atomic_init(&is_writing, true);
+    StressArgs args[THREADS_COUNT + 1];
+    pthread_t threads[THREADS_COUNT + 1];
+    for (int i = 0; i <= THREADS_COUNT; i++) {
+        args[i] = (StressArgs) {list, i, &is_writing, false};
+    }
+    ASSERT_TEST(pthread_create(&threads[THREADS_COUNT], NULL, runReader, &args[THREADS_COUNT]) == 0, destroy);
+    bool is_thread_running[THREADS_COUNT];
+    for (int i = 0; i < THREADS_COUNT; i++) {
+        is_thread_running[i] = pthread_create(&threads[i], NULL, runWriter, &args[i]) == 0;
+        if (!is_thread_running[i]) {
+            runWriter(&args[i]);
+        }
+    }
+    for (int i = 0; i < THREADS_COUNT; i++) {
+        if (is_thread_running[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    atomic_store(&is_writing, false);
+    pthread_join(threads[THREADS_COUNT], NULL);
+
+    for (int i = 0; i <= THREADS_COUNT; i++) {
+        ASSERT_TEST(args[i].is_ordered, destroy);
+    }
+
+    LockFreeThread thread = lockFreeListRegisterThread(list);
+    ASSERT_TEST(thread != NULL, destroy);
+    OrderCheck check = checkListOrder(thread);
+    ASSERT_TEST(check.is_ordered, destroy);
+    ASSERT_TEST(check.count == THREADS_COUNT * (KEYS_PER_THREAD / 2), destroy);
+    for (int i = 0; i < KEYS_PER_THREAD * THREADS_COUNT; i++) {
+        ASSERT_TEST(lockFreeListContains(thread, getItem(i)) == ((i / THREADS_COUNT) % 2 == 0), destroy);
+    }
+
+    destroy:
+    lockFreeListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING contention on the same keys ============= */
+typedef struct {
+    LockFreeList list;
+    unsigned int seed;
+    int inserted_count;
+    int removed_count;
+} ContentionArgs;
+
+/* Randomly inserts and removes a few keys shared by all the threads, counting the operations that succeeded */
+static void *runContender(void *argument) {
+    ContentionArgs *args = argument;
+    LockFreeThread thread = lockFreeListRegisterThread(args->list);
+    for (int i = 0; thread != NULL && i < CONTENDED_OPERATIONS_COUNT; i++) {
+        args->seed = args->seed * 1103515245 + 12345;
+        NodeData item = getItem((args->seed >> 16) % CONTENDED_KEYS_COUNT);
+        if ((args->seed >> 8) & 1) {
+            args->inserted_count += lockFreeListInsert(thread, item);
+        } else {
+            args->removed_count += lockFreeListRemove(thread, item);
+        }
+    }
+    lockFreeListUnregisterThread(thread);
+    return NULL;
+}
+
+bool testLockFreeListContendedKeys() {
+    bool result = true;
+    atomic_store(&freed_items_count, 0);
+    LockFreeList list = lockFreeListCreate(compareItems, countFreedItem);
+    ASSERT_TEST(list != NULL, destroy);
+
+    ContentionArgs args[THREADS_COUNT];
+    pthread_t threads[THREADS_COUNT];
+    bool is_thread_running[THREADS_COUNT];
+    for (int i = 0; i < THREADS_COUNT; i++) {
+        args[i] = (ContentionArgs) {list, i + 1, 0, 0};
+        is_thread_running[i] = pthread_create(&threads[i], NULL, runContender, &args[i]) == 0;
+        if (!is_thread_running[i]) {
+            runContender(&args[i]);
+        }
+    }
+    int inserted_count = 0;
+    int removed_count = 0;
+    for (int i = 0; i < THREADS_COUNT; i++) {
+        if (is_thread_running[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        inserted_count += args[i].inserted_count;
+        removed_count += args[i].removed_count;
+    }
+
+    LockFreeThread thread = lockFreeListRegisterThread(list);
+    ASSERT_TEST(thread != NULL, destroy);
+    OrderCheck check = checkListOrder(thread);
+    ASSERT_TEST(check.is_ordered, destroy);
+    ASSERT_TEST(check.count == inserted_count - removed_count, destroy);
+    // Removed items are freed once no thread can read them, and the rest when the list is destroyed
+    ASSERT_TEST(atomic_load(&freed_items_count) <= removed_count, destroy);
+    lockFreeListDestroy(list);
+    list = NULL;
+    ASSERT_TEST(atomic_load(&freed_items_count) == inserted_count, destroy);
+
+    destroy:
+    lockFreeListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING registering and unregistering threads ============= */
+static atomic_int freed_departed_items_count;
+
+/* Counts the freed items that the departed thread of testLockFreeListReusesUnregisteredThreads removed */
+static void countFreedDepartedItem(NodeData data) {
+    if ((intptr_t) data < DEPARTED_ITEMS_COUNT) {
+        atomic_fetch_add(&freed_departed_items_count, 1);
+    }
+}
+
+bool testLockFreeListReusesUnregisteredThreads() {
+    bool result = true;
+    atomic_store(&freed_departed_items_count, 0);
+    LockFreeList list = lockFreeListCreate(compareItems, countFreedDepartedItem);
+    ASSERT_TEST(list != NULL, destroy);
+
+    // The departed thread leaves the items it removed waiting in its bags
+    LockFreeThread departed_thread = lockFreeListRegisterThread(list);
+    ASSERT_TEST(departed_thread != NULL, destroy);
+    for (int i = 0; i < DEPARTED_ITEMS_COUNT; i++) {
+        ASSERT_TEST(lockFreeListInsert(departed_thread, getItem(i)), destroy);
+    }
+    for (int i = 0; i < DEPARTED_ITEMS_COUNT; i++) {
+        ASSERT_TEST(lockFreeListRemove(departed_thread, getItem(i)), destroy);
+    }
+    lockFreeListUnregisterThread(departed_thread);
+
+    // The next thread takes its handle over, and frees those items as the epochs go on
+    LockFreeThread thread = lockFreeListRegisterThread(list);
+    ASSERT_TEST(thread == departed_thread, destroy);
+    LockFreeThread other_thread = lockFreeListRegisterThread(list);
+    ASSERT_TEST(other_thread != NULL && other_thread != thread, destroy);
+    lockFreeListUnregisterThread(other_thread);
+    for (int i = 0; i < KEYS_PER_THREAD; i++) {
+        ASSERT_TEST(lockFreeListInsert(thread, getItem(DEPARTED_ITEMS_COUNT + i)), destroy);
+        ASSERT_TEST(lockFreeListRemove(thread, getItem(DEPARTED_ITEMS_COUNT + i)), destroy);
+    }
+    ASSERT_TEST(atomic_load(&freed_departed_items_count) == DEPARTED_ITEMS_COUNT, destroy);
+
+    // Threads that come and go one at a time keep reusing the same handles
+    for (int i = 0; i < KEYS_PER_THREAD; i++) {
+        LockFreeThread passing_thread = lockFreeListRegisterThread(list);
+        ASSERT_TEST(passing_thread == other_thread, destroy);
+        lockFreeListUnregisterThread(passing_thread);
+    }
+    lockFreeListUnregisterThread(thread);
+
+    destroy:
+    lockFreeListDestroy(list);
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testLockFreeListSingleThread,
+        testLockFreeListConcurrentInsertRemove,
+        testLockFreeListContendedKeys,
+        testLockFreeListReusesUnregisteredThreads
+};
+
+const char *testNames[] = {
+        "testLockFreeListSingleThread",
+        "testLockFreeListConcurrentInsertRemove",
+        "testLockFreeListContendedKeys",
+        "testLockFreeListReusesUnregisteredThreads"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testLockFreeListSingleThread",
+        "Please refer to the testing code at function: testLockFreeListConcurrentInsertRemove",
+        "Please refer to the testing code at function: testLockFreeListContendedKeys",
+        "Please refer to the testing code at function: testLockFreeListReusesUnregisteredThreads"
+};
+
+
+#define NUMBER_TESTS 4
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: lock_free_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}
@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include <limits.h>
+#include "persistent_priority_queue.h"
+
+#define PPQ_NULL_NO_SIZE -1
+
+/* An element and its priority. Shared by all the heap nodes that were copied from the node that holds it */
+typedef struct PersistentEntry_t {
+    PQElement element;
+    PQElementPriority priority;
+    long sequence;
+    int reference_count;
+} *PersistentEntry;
+
+/* A node of a leftist heap. Nodes are never changed after they are created, so they can be shared between
+ * versions. rank is the length of the shortest path to an empty subtree, which is always on the right.
+ * Once a node is left without references its entry is released and the field links it to the next node to free */
+typedef struct PersistentNode_t {
+    union {
+        PersistentEntry entry;
+        struct PersistentNode_t *next_released;
+    } content;
+    struct PersistentNode_t *left;
+    struct PersistentNode_t *right;
+    int rank;
+    int reference_count;
+} *PersistentNode;
+
+struct PersistentPriorityQueue_t {
+    PersistentNode root;
+    int64_t size;
+    long next_sequence;
+    CopyPQElement copy_element;
+    FreePQElement free_element;
+    CopyPQElementPriority copy_priority;
+    FreePQElementPriority free_priority;
+    ComparePQElementPriorities compare_priorities;
+};
+
+
+/* Returns the rank of a node, where an empty subtree has rank 0 */
+static int getRank(PersistentNode node) {
+    return node == NULL ? 0 : node->rank;
+}
+
+/* Adds a reference to a node (if it is not NULL) and returns it */
+static PersistentNode retainNode(PersistentNode node) {
+    if (node != NULL) {
+        node->reference_count++;
+    }
+    return node;
+}
+
+/* Removes a reference from an entry, freeing it with its element and priority if it was the last one */
+static void releaseEntry(PersistentPriorityQueue version, PersistentEntry entry) {
+    entry->reference_count--;
+    if (entry->reference_count > 0) {
+        return;
+    }
+    version->free_element(entry->element);
+    version->free_priority(entry->priority);
+    free(entry);
+}
+
+/* Removes a reference from a node and frees every node that is left without references.
+ * Uses a list of released nodes instead of recursion, since the left spine of a leftist heap can be long */
+static void releaseNode(PersistentPriorityQueue version, PersistentNode node) {
+    if (node == NULL || --node->reference_count > 0) {
+        return;
+    }
+
+    releaseEntry(version, node->content.entry);
+    node->content.next_released = NULL;
+    while (node != NULL) {
+        PersistentNode next_node = node->content.next_released;
+        PersistentNode children[] = {node->left, node->right};
+        for (int i = 0; i < 2; i++) {
+            if (children[i] != NULL && --children[i]->reference_count == 0) {
+                releaseEntry(version, children[i]->content.entry);
+                children[i]->content.next_released = next_node;
+                next_node = children[i];
+            }
+        }
+        free(node);
+        node = next_node;
+    }
+}
+
+/* Returns whether the entry first comes before the entry second in the queue's order */
+static bool isBefore(PersistentPriorityQueue version, PersistentEntry first, PersistentEntry second) {
+    int compare_result = version->compare_priorities(first->priority, second->priority);
+    return compare_result > 0 || (compare_result == 0 && first->sequence < second->sequence);
+}
+
+/* Creates a node that holds entry, with the given children (the node takes their references) */
+static PersistentNode createNode(PersistentEntry entry, PersistentNode left, PersistentNode right) {
+    PersistentNode node = malloc(sizeof(*node));
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (getRank(left) < getRank(right)) {
+        PersistentNode temp = left;
+        left = right;
+        right = temp;
+    }
+    node->content.entry = entry;
+    entry->reference_count++;
+    node->left = left;
+    node->right = right;
+    node->rank = getRank(right) + 1;
+    node->reference_count = 1;
+    return node;
+}
+
+/* Merges two heaps into a new heap and returns a reference to it, without changing any existing node.
+ * Only the nodes on the right spines are copied. Sets is_out_of_memory to true if an allocation failed */
+static PersistentNode mergeHeaps(PersistentPriorityQueue version, PersistentNode first, PersistentNode second,
+                                 bool *is_out_of_memory) {
+    if (first == NULL) {
+        return retainNode(second);
+    }
+    if (second == NULL) {
+        return retainNode(first);
+    }
+    if (!isBefore(version, first->content.entry, second->content.entry)) {
+        PersistentNode temp = first;
+        first = second;
+        second = temp;
+    }
+
+    PersistentNode merged_right = mergeHeaps(version, first->right, second, is_out_of_memory);
+    if (*is_out_of_memory) {
+        return NULL;
+    }
+
+    PersistentNode node = createNode(first->content.entry, retainNode(first->left), merged_right);
+    if (node == NULL) {
+        releaseNode(version, first->left);
+        releaseNode(version, merged_right);
+        *is_out_of_memory = true;
+    }
+    return node;
+}
+
+/* Creates a new version with the callbacks of version and the given root (the version takes its reference) */
+static PersistentPriorityQueue createVersion(PersistentPriorityQueue version, PersistentNode root, int64_t size,
+                                             long next_sequence) {
+    PersistentPriorityQueue new_version = malloc(sizeof(*new_version));
+    if (new_version == NULL) {
+        releaseNode(version, root);
+        return NULL;
+    }
+
+    *new_version = *version;
+    new_version->root = root;
+    new_version->size = size;
+    new_version->next_sequence = next_sequence;
+    return new_version;
+}
+
+
+PersistentPriorityQueue ppqCreate(CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities) {
+    if (copy_element == NULL || free_element == NULL || copy_priority == NULL || free_priority == NULL ||
+        compare_priorities == NULL) {
+        return NULL;
+    }
+
+    PersistentPriorityQueue version = malloc(sizeof(*version));
+    if (version == NULL) {
+        return NULL;
+    }
+
+    version->root = NULL;
+    version->size = 0;
+    version->next_sequence = 0;
+    version->copy_element = copy_element;
+    version->free_element = free_element;
+    version->copy_priority = copy_priority;
+    version->free_priority = free_priority;
+    version->compare_priorities = compare_priorities;
+    return version;
+}
+
+void ppqDestroy(PersistentPriorityQueue version) {
+    if (version == NULL) {
+        return;
+    }
+    releaseNode(version, version->root);
+    free(version);
+}
+
+PersistentPriorityQueue ppqCopy(PersistentPriorityQueue version) {
+    if (version == NULL) {
+        return NULL;
+    }
+    return createVersion(version, retainNode(version->root), version->size, version->next_sequence);
+}
+
+int ppqGetSize(PersistentPriorityQueue version) {
+    int64_t size = ppqGetSize64(version);
+    return size < INT_MAX ? (int) size : INT_MAX;
+}
+
+int64_t ppqGetSize64(PersistentPriorityQueue version) {
+    if (version == NULL) {
+        return PPQ_NULL_NO_SIZE;
+    }
+    return version->size;
+}
+
+PersistentPriorityQueue ppqInsert(PersistentPriorityQueue version, PQElement element, PQElementPriority priority) {
+    if (version == NULL || element == NULL || priority == NULL) {
+        return NULL;
+    }
+
+    PersistentEntry entry = malloc(sizeof(*entry));
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->element = version->copy_element(element);
+    entry->priority = version->copy_priority(priority);
+    entry->sequence = version->next_sequence;
+    entry->reference_count = 1;
+    if (entry->element == NULL || entry->priority == NULL) {
+        releaseEntry(version, entry);
+        return NULL;
+    }
+
+    PersistentNode leaf = createNode(entry, NULL, NULL);
+    releaseEntry(version, entry);
+    if (leaf == NULL) {
+        return NULL;
+    }
+
+    bool is_out_of_memory = false;
+    PersistentNode root = mergeHeaps(version, version->root, leaf, &is_out_of_memory);
+    releaseNode(version, leaf);
+    if (is_out_of_memory) {
+        return NULL;
+    }
+
+    return createVersion(version, root, version->size + 1, version->next_sequence + 1);
+}
+
+PersistentPriorityQueue ppqRemove(PersistentPriorityQueue version) {
+    if (version == NULL) {
+        return NULL;
+    }
+    if (version->root == NULL) {
+        return ppqCopy(version);
+    }
+
+    bool is_out_of_memory = false;
+    PersistentNode root = mergeHeaps(version, version->root->left, version->root->right, &is_out_of_memory);
+    if (is_out_of_memory) {
+        return NULL;
+    }
+
+    return createVersion(version, root, version->size - 1, version->next_sequence);
+}
+
+PQElement ppqGetFirst(PersistentPriorityQueue version) {
+    if (version == NULL || version->root == NULL) {
+        return NULL;
+    }
+    return version->root->content.entry->element;
+}
+
+PQElementPriority ppqGetFirstPriority(PersistentPriorityQueue version) {
+    if (version == NULL || version->root == NULL) {
+        return NULL;
+    }
+    return version->root->content.entry->priority;
+}
@@ -0,0 +1,135 @@
+#ifndef PERSISTENT_PRIORITY_QUEUE_H
+#define PERSISTENT_PRIORITY_QUEUE_H
+
+#include <stdbool.h>
+#include "priority_queue.h"
+
+/**
+* Persistent (immutable) Priority Queue Container
+*
+* Implements a persistent priority queue, where every version of the queue stays readable after it is changed.
+* Changing functions do not change the version they get, but return a new version instead. The new version
+* shares most of its memory with the old one (it is implemented as a persistent leftist heap, so every change
+* allocates O(log n) new nodes), and memory that is shared between versions is freed by reference counting once
+* no version uses it anymore.
+* The order of the elements is the same as in PriorityQueue: the highest priority first, and the insertion order
+* as the tie-breaker between two equal priorities.
+*
+* The following functions are available:
+*   ppqCreate		    - Creates a new empty version of a persistent priority queue
+*   ppqDestroy		    - Deletes a version and frees all the memory that no other version uses
+*   ppqCopy		        - Creates a new handle to an existing version in O(1)
+*   ppqGetSize		    - Returns the size of a version
+*   ppqGetSize64	    - Returns the size of a version, which may exceed INT_MAX
+*   ppqInsert	        - Returns a new version with an element inserted with a given priority
+*   ppqRemove		    - Returns a new version without the highest priority element
+*   ppqGetFirst	        - Returns the highest priority element of a version
+*   ppqGetFirstPriority - Returns the priority of the highest priority element of a version
+*/
+
+/** Type for defining a version of a persistent priority queue */
+typedef struct PersistentPriorityQueue_t *PersistentPriorityQueue;
+
+
+/**
+* ppqCreate: Allocates a new empty version of a persistent priority queue.
+*
+* @param copy_element - Function pointer to be used for copying data elements into the priority queue.
+* @param free_element - Function pointer to be used for removing data elements from the priority queue
+* @param copy_priority - Function pointer to be used for copying priority into the priority queue.
+* @param free_priority - Function pointer to be used for removing priority from the priority queue
+* @param compare_priorities - Function pointer to be used for comparing priorities.
+* @return
+* 	NULL - if one of the parameters is NULL or allocations failed.
+* 	A new empty version in case of success.
+*/
+PersistentPriorityQueue ppqCreate(CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities);
+
+/**
+* ppqDestroy: Deallocates a version of a persistent priority queue. Elements and priorities that are not in any
+* other version are freed using the free functions.
+*
+* @param version - Target version to be deallocated. If version is NULL nothing will be done
+*/
+void ppqDestroy(PersistentPriorityQueue version);
+
+/**
+* ppqCopy: Creates a new handle to the same version, in O(1) and without copying any element.
+* Both handles have to be destroyed separately.
+*
+* @param version - Target version.
+* @return
+* 	NULL if a NULL was sent or a memory allocation failed.
+* 	A new handle to the version otherwise.
+*/
+PersistentPriorityQueue ppqCopy(PersistentPriorityQueue version);
+
+/**
+* ppqGetSize: Returns the number of elements in a version of a persistent priority queue
+* @param version - The version which size is requested
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	INT_MAX if the version has more elements than that (see ppqGetSize64).
+* 	Otherwise the number of elements in the version.
+*/
+int ppqGetSize(PersistentPriorityQueue version);
+
+/**
+* ppqGetSize64: Returns the number of elements in a version of a persistent priority queue, which may exceed INT_MAX
+* @param version - The version which size is requested
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the version.
+*/
+int64_t ppqGetSize64(PersistentPriorityQueue version);
+
+/**
+*   ppqInsert: Returns a new version that has the elements of version and also a copy of element with a copy
+*   of priority. version itself is not changed.
+*
+* @param version - The version to insert the element to.
+* @param element - The element which need to be added.
+* @param priority - The priority to associate with the given element.
+* @return
+* 	NULL if a NULL was sent as one of the parameters or an allocation failed.
+* 	The new version otherwise.
+*/
+PersistentPriorityQueue ppqInsert(PersistentPriorityQueue version, PQElement element, PQElementPriority priority);
+
+/**
+*   ppqRemove: Returns a new version that has the elements of version without its highest priority element.
+*   If there are multiple elements with the same highest priority, the first inserted element is removed.
+*   version itself is not changed. If version is empty, the new version is empty too.
+*
+* @param version - The version to remove the element from.
+* @return
+* 	NULL if a NULL was sent or an allocation failed.
+* 	The new version otherwise.
+*/
+PersistentPriorityQueue ppqRemove(PersistentPriorityQueue version);
+
+/**
+*	ppqGetFirst: Returns the highest priority element in a version, in O(1).
+*
+* @param version - The version to return the element of.
+* @return
+* 	NULL if a NULL pointer was sent or the version is empty.
+* 	The first element of the version otherwise
+*/
+PQElement ppqGetFirst(PersistentPriorityQueue version);
+
+/**
+*	ppqGetFirstPriority: Returns the priority of the highest priority element in a version, in O(1).
+*
+* @param version - The version to return the priority of.
+* @return
+* 	NULL if a NULL pointer was sent or the version is empty.
+* 	The priority of the first element of the version otherwise
+*/
+PQElementPriority ppqGetFirstPriority(PersistentPriorityQueue version);
+
+#endif /* PERSISTENT_PRIORITY_QUEUE_H */
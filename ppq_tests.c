@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "persistent_priority_queue.h"
+
+#define PPQ PersistentPriorityQueue
+
+
+static PQElementPriority copyIntGeneric(PQElementPriority n) {
+    if (!n) {
+        return NULL;
+    }
+    int *copy = malloc(sizeof(*copy));
+    if (!copy) {
+        return NULL;
+    }
+    *copy = *(int *) n;
+    return copy;
+}
+
+static void freeIntGeneric(PQElementPriority n) {
+    free(n);
+}
+
+static int compareIntsGeneric(PQElementPriority n1, PQElementPriority n2) {
+    return (*(int *) n1 - *(int *) n2);
+}
+
+PPQ createPPQ() {
+    return ppqCreate(copyIntGeneric, freeIntGeneric, copyIntGeneric, freeIntGeneric, compareIntsGeneric);
+}
+
+
+/* ============= TESTING ppqCreate ============= */
+bool testPPQCreateNullArgument() {
+    bool result = true;
+    PPQ ppq = ppqCreate(copyIntGeneric, NULL, copyIntGeneric, freeIntGeneric, compareIntsGeneric);
+    ASSERT_TEST(ppq == NULL, destroy);
+
+    destroy:
+    ppqDestroy(ppq);
+    return result;
+}
+
+bool testPPQCreateIsEmpty() {
+    bool result = true;
+    PPQ ppq = createPPQ();
+    ASSERT_TEST(ppq != NULL, destroy);
+    ASSERT_TEST(ppqGetSize(ppq) == 0, destroy);
+    ASSERT_TEST(ppqGetFirst(ppq) == NULL, destroy);
+    ASSERT_TEST(ppqGetSize(NULL) == -1, destroy);
+    ASSERT_TEST(ppqGetSize64(NULL) == -1, destroy);
+
+    destroy:
+    ppqDestroy(ppq);
+    return result;
+}
+
+/* ============= TESTING ppqInsert / ppqRemove ============= */
+bool testPPQRemovesByPriorityAndInsertionOrder() {
+    bool result = true;
+    int elements[] = {1, 2, 3, 4, 5};
+    int priorities[] = {3, 8, 3, 8, 1};
+    PPQ versions[6] = {createPPQ()};
+    for (int i = 0; i < 5; i++) {
+        versions[i + 1] = ppqInsert(versions[i], &elements[i], &priorities[i]);
+        ASSERT_TEST(versions[i + 1] != NULL, destroy);
+    }
+
+    int expected_order[] = {2, 4, 1, 3, 5};
+    PPQ current = ppqCopy(versions[5]);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TEST(*(int *) ppqGetFirst(current) == expected_order[i], destroy_current);
+        PPQ next = ppqRemove(current);
+        ppqDestroy(current);
+        current = next;
+        ASSERT_TEST(current != NULL, destroy_current);
+    }
+    ASSERT_TEST(ppqGetSize(current) == 0, destroy_current);
+
+    destroy_current:
+    ppqDestroy(current);
+    destroy:
+    for (int i = 0; i < 6; i++) {
+        ppqDestroy(versions[i]);
+    }
+    return result;
+}
+
+bool testPPQOldVersionsStayReadable() {
+    bool result = true;
+    PPQ versions[21] = {createPPQ()};
+    for (int i = 0; i < 20; i++) {
+        int priority = (i * 7) % 20;
+        versions[i + 1] = ppqInsert(versions[i], &i, &priority);
+        ASSERT_TEST(versions[i + 1] != NULL, destroy);
+    }
+
+    PPQ removed = ppqRemove(versions[20]);
+    ASSERT_TEST(removed != NULL, destroy);
+    ASSERT_TEST(ppqGetSize(removed) == 19, destroy_removed);
+    ASSERT_TEST(ppqGetSize64(removed) == 19, destroy_removed);
+
+    // Every checkpoint still has its own size and top element
+    int best_priority = -1;
+    for (int i = 0; i < 20; i++) {
+        int priority = (i * 7) % 20;
+        if (priority > best_priority) {
+            best_priority = priority;
+        }
+        ASSERT_TEST(ppqGetSize(versions[i + 1]) == i + 1, destroy_removed);
+        ASSERT_TEST(*(int *) ppqGetFirstPriority(versions[i + 1]) == best_priority, destroy_removed);
+    }
+
+    destroy_removed:
+    ppqDestroy(removed);
+    destroy:
+    for (int i = 0; i < 21; i++) {
+        ppqDestroy(versions[i]);
+    }
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testPPQCreateNullArgument,
+        testPPQCreateIsEmpty,
+        testPPQRemovesByPriorityAndInsertionOrder,
+        testPPQOldVersionsStayReadable
+};
+
+const char *testNames[] = {
+        "testPPQCreateNullArgument",
+        "testPPQCreateIsEmpty",
+        "testPPQRemovesByPriorityAndInsertionOrder",
+        "testPPQOldVersionsStayReadable"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testPPQCreateNullArgument",
+        "Please refer to the testing code at function: testPPQCreateIsEmpty",
+        "Please refer to the testing code at function: testPPQRemovesByPriorityAndInsertionOrder",
+        "Please refer to the testing code at function: testPPQOldVersionsStayReadable"
+};
+
+
+#define NUMBER_TESTS 4
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: persistent_priority_queue_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}
@@ -0,0 +1,369 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "priority_queue.h"
+
+/* Replays a trace recorded by pqStartTrace against a chosen priority queue and reports how long every kind of
+ * operation took. The trace has to be of a queue of int elements and int priorities, written with
+ * writeIntGeneric below (a raw int each) under INT_SERIALIZER_ID, as the tests do:
+ *
+ *     pqStartTrace(queue, trace_file, INT_SERIALIZER_ID, writeIntGeneric, writeIntGeneric);
+ *
+ * A trace with another magic, version or serializer id in its header is rejected.
+ * The whole trace is read to memory before the replay, so only the queue operations are timed.
+ * Reading the clock costs about as much as the cheap operations, so the clock is not read around every call:
+ * every run of consecutive records of the same operation is timed as one batch, the cost of reading the clock
+ * is subtracted from it, and every operation reports the mean time of its calls. The total is the time of the
+ * whole replay.
+ * Usage: pq_replay <trace file> [list | bounded <capacity> | external <memory budget>]
+ */
+
+#define TRACE_OPERATIONS_COUNT (PQ_TRACE_FOR_EACH + 1)
+#define INT_SERIALIZER_ID 0x494E5434 /* "INT4", a raw int of 4 bytes */
+#define INITIAL_RECORDS_CAPACITY 1024
+#define NANOSECONDS_IN_SECOND 1000000000L
+#define CLOCK_CALIBRATION_ROUNDS 1000
+
+typedef struct {
+    PQTraceOperation operation;
+    int element;
+    int priority;
+    int new_priority;
+} TraceRecord;
+
+typedef struct {
+    long calls;
+    long nanoseconds;
+} OperationTiming;
+
+static const char *operation_names[TRACE_OPERATIONS_COUNT] = {
+        "insert",
+        "change priority",
+        "remove first",
+        "remove last",
+        "remove element",
+        "remove all",
+        "contains",
+        "count",
+        "get priority",
+        "get first",
+        "clear",
+        "clear keep capacity",
+        "get first entry",
+        "get next",
+        "get last",
+        "get size",
+        "for each"
+};
+
+
+static PQElement copyIntGeneric(PQElement n) {
+    if (!n) {
+        return NULL;
+    }
+    int *copy = malloc(sizeof(*copy));
+    if (!copy) {
+        return NULL;
+    }
+    *copy = *(int *) n;
+    return copy;
+}
+
+static void freeIntGeneric(PQElement n) {
+    free(n);
+}
+
+static int compareIntsGeneric(PQElementPriority n1, PQElementPriority n2) {
+    return (*(int *) n1 - *(int *) n2);
+}
+
+static bool equalIntsGeneric(PQElement n1, PQElement n2) {
+    return *(int *) n1 == *(int *) n2;
+}
+
+static bool writeIntGeneric(PQElement n, FILE *file) {
+    return fwrite(n, sizeof(int), 1, file) == 1;
+}
+
+static PQElement readIntGeneric(FILE *file) {
+    int value;
+    if (fread(&value, sizeof(value), 1, file) != 1) {
+        return NULL;
+    }
+    return copyIntGeneric(&value);
+}
+
+
+/* Reads the header of a trace file and checks that it is a trace of this version written by writeIntGeneric.
+ * Returns false (after reporting why) otherwise */
+static bool readTraceHeader(FILE *trace_file) {
+    char magic[PQ_TRACE_MAGIC_LENGTH];
+    if (fread(magic, 1, PQ_TRACE_MAGIC_LENGTH, trace_file) != PQ_TRACE_MAGIC_LENGTH ||
+        memcmp(magic, PQ_TRACE_MAGIC, PQ_TRACE_MAGIC_LENGTH) != 0) {
+        fprintf(stderr, "Not a priority queue trace\n");
+        return false;
+    }
+
+    int version = fgetc(trace_file);
+    if (version != PQ_TRACE_VERSION) {
+        fprintf(stderr, "Unsupported trace version %d (expected %d)\n", version, PQ_TRACE_VERSION);
+        return false;
+    }
+
+    uint32_t serializer_id = 0;
+    for (int i = 0; i < 4; i++) {
+        int byte = fgetc(trace_file);
+        if (byte == EOF) {
+            fprintf(stderr, "The trace ends in the middle of its header\n");
+            return false;
+        }
+        serializer_id = (serializer_id << 8) | (uint32_t) byte;
+    }
+    if (serializer_id != INT_SERIALIZER_ID) {
+        fprintf(stderr, "Unsupported serializer id 0x%08lX (expected 0x%08lX, raw ints)\n",
+                (unsigned long) serializer_id, (unsigned long) INT_SERIALIZER_ID);
+        return false;
+    }
+    return true;
+}
+
+/* Reads a single int argument of a record. Returns false if the trace ended in the middle of the record */
+static bool readIntArgument(FILE *trace_file, int *value) {
+    return fread(value, sizeof(*value), 1, trace_file) == 1;
+}
+
+/* Reads the arguments of a record whose operation byte was already read */
+static bool readRecordArguments(FILE *trace_file, TraceRecord *record) {
+    switch (record->operation) {
+        case PQ_TRACE_INSERT:
+            return readIntArgument(trace_file, &record->element) && readIntArgument(trace_file, &record->priority);
+        case PQ_TRACE_CHANGE_PRIORITY:
+            return readIntArgument(trace_file, &record->element) &&
+                   readIntArgument(trace_file, &record->priority) &&
+                   readIntArgument(trace_file, &record->new_priority);
+        case PQ_TRACE_REMOVE_ELEMENT:
+        case PQ_TRACE_REMOVE_ALL:
+        case PQ_TRACE_CONTAINS:
+        case PQ_TRACE_COUNT:
+        case PQ_TRACE_GET_PRIORITY:
+            return readIntArgument(trace_file, &record->element);
+        default:
+            return true;
+    }
+}
+
+/* Reads the header and all the records of a trace file to a newly allocated array. Returns NULL if the trace is
+ * malformed, was not written by writeIntGeneric or allocations failed */
+static TraceRecord *readTrace(FILE *trace_file, int *records_count) {
+    if (!readTraceHeader(trace_file)) {
+        return NULL;
+    }
+
+    int capacity = INITIAL_RECORDS_CAPACITY;
+    TraceRecord *records = malloc(capacity * sizeof(*records));
+    *records_count = 0;
+
+    int operation;
+    while (records != NULL && (operation = fgetc(trace_file)) != EOF) {
+        if (operation >= TRACE_OPERATIONS_COUNT) {
+            fprintf(stderr, "Unknown operation %d in record %d\n", operation, *records_count);
+            free(records);
+            return NULL;
+        }
+        if (*records_count == capacity) {
+            capacity *= 2;
+            TraceRecord *new_records = realloc(records, capacity * sizeof(*records));
+            if (new_records == NULL) {
+                free(records);
+                return NULL;
+            }
+            records = new_records;
+        }
+
+        TraceRecord *record = &records[*records_count];
+        record->operation = (PQTraceOperation) operation;
+        if (!readRecordArguments(trace_file, record)) {
+            fprintf(stderr, "The trace ends in the middle of record %d\n", *records_count);
+            free(records);
+            return NULL;
+        }
+        (*records_count)++;
+    }
+
+    return records;
+}
+
+/* Creates the queue the trace is replayed against, by the command line arguments after the trace file */
+static PriorityQueue createReplayQueue(int argc, char **argv) {
+    if (argc == 2 || (argc == 3 && strcmp(argv[2], "list") == 0)) {
+        return pqCreate(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                        compareIntsGeneric);
+    }
+    if (argc != 4) {
+        return NULL;
+    }
+
+    int size = strtol(argv[3], NULL, 10);
+    if (strcmp(argv[2], "bounded") == 0) {
+        return pqCreateBounded(size, copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                               freeIntGeneric, compareIntsGeneric);
+    }
+    if (strcmp(argv[2], "external") == 0) {
+        return pqCreateExternal(size, copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                freeIntGeneric, compareIntsGeneric, writeIntGeneric, readIntGeneric,
+                                writeIntGeneric, readIntGeneric);
+    }
+    return NULL;
+}
+
+/* The visit function of replayed pqForEach calls, so only the traversal itself is timed */
+static void visitNothing(PQElement element, PQElementPriority priority, void *context) {
+    (void) element;
+    (void) priority;
+    (void) context;
+}
+
+static void replayRecord(PriorityQueue queue, TraceRecord *record) {
+    switch (record->operation) {
+        case PQ_TRACE_INSERT:
+            pqInsert(queue, &record->element, &record->priority);
+            break;
+        case PQ_TRACE_CHANGE_PRIORITY:
+            pqChangePriority(queue, &record->element, &record->priority, &record->new_priority);
+            break;
+        case PQ_TRACE_REMOVE_FIRST:
+            pqRemoveFirst(queue);
+            break;
+        case PQ_TRACE_REMOVE_LAST:
+            pqRemoveLast(queue);
+            break;
+        case PQ_TRACE_REMOVE_ELEMENT:
+            pqRemoveElement(queue, &record->element);
+            break;
+        case PQ_TRACE_REMOVE_ALL:
+            pqRemoveAll(queue, &record->element);
+            break;
+        case PQ_TRACE_CONTAINS:
+            pqContains(queue, &record->element);
+            break;
+        case PQ_TRACE_COUNT:
+            pqCount(queue, &record->element);
+            break;
+        case PQ_TRACE_GET_PRIORITY:
+            pqGetPriority(queue, &record->element);
+            break;
+        case PQ_TRACE_GET_FIRST:
+            pqGetFirst(queue);
+            break;
+        case PQ_TRACE_CLEAR:
+            pqClear(queue);
+            break;
+        case PQ_TRACE_CLEAR_KEEP_CAPACITY:
+            pqClearKeepCapacity(queue);
+            break;
+        case PQ_TRACE_GET_FIRST_ENTRY: {
+            PQElement element;
+            PQElementPriority priority;
+            pqGetFirstEntry(queue, &element, &priority);
+            break;
+        }
+        case PQ_TRACE_GET_NEXT:
+            pqGetNext(queue);
+            break;
+        case PQ_TRACE_GET_LAST:
+            pqGetLast(queue);
+            break;
+        case PQ_TRACE_GET_SIZE:
+            pqGetSize64(queue);
+            break;
+        case PQ_TRACE_FOR_EACH:
+            pqForEach(queue, visitNothing, NULL);
+            break;
+    }
+}
+
+static long getNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NANOSECONDS_IN_SECOND + now.tv_nsec;
+}
+
+/* Returns the mean nanoseconds between two consecutive readings of the clock */
+static long getClockOverhead() {
+    long start = getNanoseconds();
+    for (int i = 0; i < CLOCK_CALIBRATION_ROUNDS; i++) {
+        getNanoseconds();
+    }
+    return (getNanoseconds() - start) / (CLOCK_CALIBRATION_ROUNDS + 1);
+}
+
+/* Replays the records in batches of consecutive records of the same operation, adding the time of every batch
+ * to the timing of its operation. Returns the elapsed nanoseconds of the whole replay */
+static long replayTrace(PriorityQueue queue, TraceRecord *records, int records_count,
+                        OperationTiming timings[TRACE_OPERATIONS_COUNT]) {
+    long clock_overhead = getClockOverhead();
+    long replay_start = getNanoseconds();
+    int batch_start = 0;
+    while (batch_start < records_count) {
+        PQTraceOperation operation = records[batch_start].operation;
+        int batch_end = batch_start;
+        long start = getNanoseconds();
+        while (batch_end < records_count && records[batch_end].operation == operation) {
+            replayRecord(queue, &records[batch_end]);
+            batch_end++;
+        }
+        long elapsed = getNanoseconds() - start - clock_overhead;
+
+        timings[operation].calls += batch_end - batch_start;
+        timings[operation].nanoseconds += elapsed > 0 ? elapsed : 0;
+        batch_start = batch_end;
+    }
+    return getNanoseconds() - replay_start;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 4) {
+        fprintf(stdout, "Usage: pq_replay <trace file> [list | bounded <capacity> | external <memory budget>]\n");
+        return 0;
+    }
+
+    FILE *trace_file = fopen(argv[1], "rb");
+    if (trace_file == NULL) {
+        fprintf(stderr, "Cannot open trace file %s\n", argv[1]);
+        return 1;
+    }
+    int records_count;
+    TraceRecord *records = readTrace(trace_file, &records_count);
+    fclose(trace_file);
+    if (records == NULL) {
+        return 1;
+    }
+
+    PriorityQueue queue = createReplayQueue(argc, argv);
+    if (queue == NULL) {
+        fprintf(stderr, "Invalid priority queue arguments\n");
+        free(records);
+        return 1;
+    }
+
+    OperationTiming timings[TRACE_OPERATIONS_COUNT] = {{0}};
+    long total_nanoseconds = replayTrace(queue, records, records_count, timings);
+
+    fprintf(stdout, "%-20s %12s %16s %12s\n", "operation", "calls", "total ns", "mean ns");
+    for (int operation = 0; operation < TRACE_OPERATIONS_COUNT; operation++) {
+        if (timings[operation].calls == 0) {
+            continue;
+        }
+        fprintf(stdout, "%-20s %12ld %16ld %12ld\n", operation_names[operation], timings[operation].calls,
+                timings[operation].nanoseconds, timings[operation].nanoseconds / timings[operation].calls);
+    }
+    fprintf(stdout, "%-20s %12d %16ld\n", "all", records_count, total_nanoseconds);
+    fprintf(stdout, "final size %d\n", pqGetSize(queue));
+
+    pqDestroy(queue);
+    free(records);
+    return 0;
+}
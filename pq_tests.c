@@ -1,8 +1,11 @@
 #include <stdlib.h>
+#include <pthread.h>
 #include "test_utilities.h"
 #include "priority_queue.h"
 
 #define PQ PriorityQueue
+#define FAILING_ELEMENT -1
+#define INT_SERIALIZER_ID 0x494E5434
 
 
 static PQElementPriority copyIntGeneric(PQElementPriority n) {
@@ -212,6 +215,7 @@ bool testPQGetSizeSampleNullArgument() {
     bool result = true;
     int size = pqGetSize(NULL);
     ASSERT_TEST(size == -1, destroy);
+    ASSERT_TEST(pqGetSize64(NULL) == -1, destroy);
     destroy:
     return result;
 }
@@ -231,6 +235,7 @@ bool testPQGetSizeStandardTest() {
 
     pqInsertRandom(pq);
     ASSERT_TEST(pqGetSize(pq) == 2, destroy);
+    ASSERT_TEST(pqGetSize64(pq) == 2, destroy);
 
     pqInsertRandom(pq);
     pqInsertRandom(pq);
@@ -723,6 +728,825 @@ bool testPQClearStandardTest() {
 
 
 
+/* ============= TESTING pqGetLast / pqRemoveLast ============= */
+bool testPQGetLastEmptyQueueReturnNull() {
+    bool result = true;
+    PQ pq = createPQ();
+
+    ASSERT_TEST(pqGetLast(NULL) == NULL, destroy);
+    ASSERT_TEST(pqGetLast(pq) == NULL, destroy);
+    ASSERT_TEST(pqRemoveLast(NULL) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqRemoveLast(pq) == PQ_SUCCESS, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQRemoveLastRemovesLowestPriorityLastInsertedFirst() {
+    bool result = true;
+    PQ pq = createPQ();
+    int elements[] = {1, 2, 3, 4, 5};
+    int priorities[] = {10, 0, 5, 0, 10};
+
+    for (int i = 0; i < 5; i++) {
+        pqInsert(pq, &elements[i], &priorities[i]);
+    }
+
+    // Lowest priority is 0, shared by 2 and 4. The last inserted of them (4) is the last element
+    ASSERT_TEST(*(int *) pqGetLast(pq) == 4, destroy);
+    ASSERT_TEST(pqRemoveLast(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(*(int *) pqGetLast(pq) == 2, destroy);
+    ASSERT_TEST(pqRemoveLast(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(*(int *) pqGetLast(pq) == 3, destroy);
+    ASSERT_TEST(pqRemoveFirst(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 5, destroy);
+    ASSERT_TEST(pqRemoveLast(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveLast(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 0, destroy);
+    ASSERT_TEST(pqGetLast(pq) == NULL, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqCreateBounded ============= */
+static int copy_int_calls = 0;
+
+static PQElement copyIntCounting(PQElement n) {
+    copy_int_calls++;
+    return copyIntGeneric(n);
+}
+
+bool testPQCreateBoundedIllegalCapacity() {
+    bool result = true;
+    PQ pq = pqCreateBounded(0, copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                            compareIntsGeneric);
+    ASSERT_TEST(pq == NULL, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQBoundedKeepsBestAndRejectsWithoutCopying() {
+    bool result = true;
+    PQ pq = pqCreateBounded(3, copyIntCounting, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                            compareIntsGeneric);
+    int elements[] = {1, 2, 3, 4, 5, 6};
+    int priorities[] = {5, 7, 3, 3, 8, 1};
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TEST(pqInsert(pq, &elements[i], &priorities[i]) == PQ_SUCCESS, destroy);
+    }
+
+    copy_int_calls = 0;
+    // Equal to the current worst priority (3), the newcomer would be placed last so it is rejected
+    ASSERT_TEST(pqInsert(pq, &elements[3], &priorities[3]) == PQ_ELEMENT_REJECTED, destroy);
+    ASSERT_TEST(pqInsert(pq, &elements[5], &priorities[5]) == PQ_ELEMENT_REJECTED, destroy);
+    ASSERT_TEST(copy_int_calls == 0, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 3, destroy);
+
+    // A better element enters and evicts the worst one (3)
+    ASSERT_TEST(pqInsert(pq, &elements[4], &priorities[4]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(copy_int_calls == 1, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 3, destroy);
+    ASSERT_TEST(!pqContains(pq, &elements[2]), destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 5, destroy);
+    ASSERT_TEST(*(int *) pqGetLast(pq) == 1, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqCreateExternal ============= */
+static bool writeIntGeneric(PQElement n, FILE *file) {
+    return fwrite(n, sizeof(int), 1, file) == 1;
+}
+
+static PQElement readIntGeneric(FILE *file) {
+    int value;
+    if (fread(&value, sizeof(value), 1, file) != 1) {
+        return NULL;
+    }
+    return copyIntGeneric(&value);
+}
+
+PriorityQueue createExternalPQ(int memory_budget) {
+    return pqCreateExternal(memory_budget, copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                            freeIntGeneric, compareIntsGeneric, writeIntGeneric, readIntGeneric, writeIntGeneric,
+                            readIntGeneric);
+}
+
+bool testPQCreateExternalIllegalArguments() {
+    bool result = true;
+    PQ pq = createExternalPQ(0);
+    ASSERT_TEST(pq == NULL, destroy);
+    pq = pqCreateExternal(1, copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                          compareIntsGeneric, writeIntGeneric, NULL, writeIntGeneric, readIntGeneric);
+    ASSERT_TEST(pq == NULL, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQExternalRemovesInSameOrderAsInMemoryQueue() {
+    bool result = true;
+    PQ external_pq = createExternalPQ(3);
+    PQ pq = createPQ();
+
+    for (int i = 0; i < 50; i++) {
+        int priority = (i * 7) % 5;
+        ASSERT_TEST(pqInsert(external_pq, &i, &priority) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqInsert(pq, &i, &priority) == PQ_SUCCESS, destroy);
+        if (i % 4 == 3) {
+            ASSERT_TEST(*(int *) pqGetFirst(external_pq) == *(int *) pqGetFirst(pq), destroy);
+            ASSERT_TEST(pqRemove(external_pq) == PQ_SUCCESS, destroy);
+            ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+        }
+    }
+
+    ASSERT_TEST(pqGetSize(external_pq) == pqGetSize(pq), destroy);
+    while (pqGetSize(pq) > 0) {
+        int *first = pqGetFirst(external_pq);
+        ASSERT_TEST(first != NULL && *first == *(int *) pqGetFirst(pq), destroy);
+        ASSERT_TEST(pqRemove(external_pq) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqGetSize(external_pq) == 0, destroy);
+    ASSERT_TEST(pqGetFirst(external_pq) == NULL, destroy);
+
+    destroy:
+    pqDestroy(external_pq);
+    pqDestroy(pq);
+    return result;
+}
+
+/* Spills many small runs, which are merged so the queue never runs out of open files */
+bool testPQExternalMergesManyRuns() {
+    bool result = true;
+    PQ external_pq = createExternalPQ(10);
+    ASSERT_TEST(external_pq != NULL, destroy);
+    for (int i = 0; i < 20000; i++) {
+        int priority = (i * 7919) % 97;
+        ASSERT_TEST(pqInsert(external_pq, &i, &priority) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqGetSize(external_pq) == 20000, destroy);
+
+    // Priorities come out in descending order, and equal priorities in insertion order
+    int last_priority = 97;
+    int last_element = -1;
+    for (int i = 0; i < 20000; i++) {
+        PQElement element;
+        PQElementPriority priority;
+        ASSERT_TEST(pqGetFirstEntry(external_pq, &element, &priority) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(*(int *) priority < last_priority ||
+                    (*(int *) priority == last_priority && *(int *) element > last_element), destroy);
+        last_priority = *(int *) priority;
+        last_element = *(int *) element;
+        ASSERT_TEST(pqRemove(external_pq) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqGetSize(external_pq) == 0, destroy);
+
+    destroy:
+    pqDestroy(external_pq);
+    return result;
+}
+
+/* Elements equal to FAILING_ELEMENT can be written only failing_element_writes_left more times, so every merge of
+ * the run that holds one fails */
+static int failing_element_writes_left;
+
+static bool writeIntFailing(PQElement n, FILE *file) {
+    if (*(int *) n == FAILING_ELEMENT) {
+        if (failing_element_writes_left == 0) {
+            return false;
+        }
+        failing_element_writes_left--;
+    }
+    return writeIntGeneric(n, file);
+}
+
+/* Merges that fail keep all the entries of their runs, and spills stop (without losing entries) once the runs
+ * can be neither merged nor added to */
+bool testPQExternalKeepsEntriesWhenMergesFail() {
+    bool result = true;
+    failing_element_writes_left = 1;
+    PQ external_pq = pqCreateExternal(1, copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                      freeIntGeneric, compareIntsGeneric, writeIntFailing, readIntGeneric,
+                                      writeIntGeneric, readIntGeneric);
+    ASSERT_TEST(external_pq != NULL, destroy);
+    int failing_element = FAILING_ELEMENT;
+    int lowest_priority = -1;
+    ASSERT_TEST(pqInsert(external_pq, &failing_element, &lowest_priority) == PQ_SUCCESS, destroy);
+
+    // The first run can never be merged again, so the runs pile up until there is no room for another one
+    int inserted_count = 1;
+    PriorityQueueResult insert_result = PQ_SUCCESS;
+    while (insert_result == PQ_SUCCESS && inserted_count < 100000) {
+        int priority = inserted_count % 100;
+        insert_result = pqInsert(external_pq, &inserted_count, &priority);
+        if (insert_result == PQ_SUCCESS) {
+            inserted_count++;
+        }
+    }
+    ASSERT_TEST(insert_result == PQ_ERROR, destroy);
+    ASSERT_TEST(pqGetSize(external_pq) == inserted_count, destroy);
+
+    // Once writing works again the runs are merged and the insertion succeeds
+    failing_element_writes_left = 1;
+    int priority = inserted_count % 100;
+    ASSERT_TEST(pqInsert(external_pq, &inserted_count, &priority) == PQ_SUCCESS, destroy);
+    inserted_count++;
+    ASSERT_TEST(pqGetSize(external_pq) == inserted_count, destroy);
+
+    // Every entry comes out once, by descending priority and then by insertion order
+    int last_priority = 100;
+    int last_element = 0;
+    for (int i = 0; i < inserted_count; i++) {
+        PQElement element;
+        PQElementPriority entry_priority;
+        ASSERT_TEST(pqGetFirstEntry(external_pq, &element, &entry_priority) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(*(int *) entry_priority < last_priority ||
+                    (*(int *) entry_priority == last_priority && *(int *) element > last_element), destroy);
+        last_priority = *(int *) entry_priority;
+        last_element = *(int *) element;
+        ASSERT_TEST(pqRemove(external_pq) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(last_element == FAILING_ELEMENT, destroy);
+    ASSERT_TEST(pqGetSize(external_pq) == 0, destroy);
+
+    destroy:
+    pqDestroy(external_pq);
+    return result;
+}
+
+/* Lookups and iteration that a spilled queue cannot answer are reported as PQ_ERROR */
+bool testPQExternalRejectsLookupAndIteration() {
+    bool result = true;
+    PQ external_pq = createExternalPQ(3);
+    PQ pq = createPQ();
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TEST(pqInsert(external_pq, &i, &i) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+
+    int present = 5;
+    int missing = 50;
+    bool is_contained = true;
+    PQElement element = NULL;
+    PQElementPriority priority = NULL;
+    ASSERT_TEST(pqLookup(external_pq, &present, &is_contained) == PQ_ERROR, destroy);
+    ASSERT_TEST(pqGetFirst(external_pq) != NULL, destroy);
+    ASSERT_TEST(pqGetNextEntry(external_pq, &element, &priority) == PQ_ERROR, destroy);
+    ASSERT_TEST(element == NULL && priority == NULL, destroy);
+
+    ASSERT_TEST(pqLookup(NULL, &present, &is_contained) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqLookup(pq, &present, NULL) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqLookup(pq, &present, &is_contained) == PQ_SUCCESS && is_contained, destroy);
+    ASSERT_TEST(pqLookup(pq, &missing, &is_contained) == PQ_SUCCESS && !is_contained, destroy);
+
+    // pqGetNextEntry walks the rest of the queue after pqGetFirst and then reports its end
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 9, destroy);
+    for (int expected = 8; expected >= 0; expected--) {
+        ASSERT_TEST(pqGetNextEntry(pq, &element, &priority) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(*(int *) element == expected && *(int *) priority == expected, destroy);
+    }
+    ASSERT_TEST(pqGetNextEntry(pq, &element, &priority) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+
+    destroy:
+    pqDestroy(external_pq);
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqCreateWithAllocator ============= */
+/* The context of allocateCounting and deallocateCounting */
+typedef struct {
+    int live_allocations;
+    int allocations_count;
+} AllocationCounts;
+
+static void *allocateCounting(size_t size, void *context) {
+    AllocationCounts *counts = context;
+    counts->live_allocations++;
+    counts->allocations_count++;
+    return malloc(size);
+}
+
+static void deallocateCounting(void *memory, void *context) {
+    ((AllocationCounts *) context)->live_allocations--;
+    free(memory);
+}
+
+bool testPQCreateWithAllocatorUsesAllocatorForAllBookkeeping() {
+    bool result = true;
+    AllocationCounts counts = {0, 0};
+    PQ pq = pqCreateWithAllocator(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                                  compareIntsGeneric, allocateCounting, deallocateCounting, &counts);
+    PQ new_pq = NULL;
+    ASSERT_TEST(pq != NULL, destroy);
+    ASSERT_TEST(counts.live_allocations > 0, destroy);
+
+    int allocations_when_empty = counts.live_allocations;
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(counts.live_allocations > allocations_when_empty, destroy);
+
+    new_pq = pqCopy(pq);
+    ASSERT_TEST(new_pq != NULL, destroy);
+    pqDestroy(new_pq);
+    new_pq = NULL;
+    pqClear(pq);
+    ASSERT_TEST(counts.live_allocations == allocations_when_empty, destroy);
+    pqDestroy(pq);
+    pq = NULL;
+    ASSERT_TEST(counts.live_allocations == 0, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(new_pq);
+    return result;
+}
+
+
+/* ============= TESTING pqClearKeepCapacity ============= */
+bool testPQClearKeepCapacityReusesStorage() {
+    bool result = true;
+    AllocationCounts counts = {0, 0};
+    PQ pq = pqCreateWithAllocator(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                                  compareIntsGeneric, allocateCounting, deallocateCounting, &counts);
+    ASSERT_TEST(pqClearKeepCapacity(NULL) == PQ_NULL_ARGUMENT, destroy);
+
+    int allocations_when_empty = counts.live_allocations;
+    for (int i = 0; i < 10; i++) {
+        pqInsert(pq, &i, &i);
+    }
+    int allocations_when_full = counts.live_allocations;
+
+    ASSERT_TEST(pqClearKeepCapacity(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 0, destroy);
+    ASSERT_TEST(pqGetFirst(pq) == NULL, destroy);
+    ASSERT_TEST(counts.live_allocations == allocations_when_full, destroy);
+
+    for (int i = 10; i > 0; i--) {
+        pqInsert(pq, &i, &i);
+    }
+    ASSERT_TEST(counts.live_allocations == allocations_when_full, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 10, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 10, destroy);
+
+    ASSERT_TEST(pqClear(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(counts.live_allocations == allocations_when_empty, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqChangePriority in place ============= */
+bool testPQChangePriorityDoesNotCopyElement() {
+    bool result = true;
+    PQ pq = pqCreate(copyIntCounting, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                     compareIntsGeneric);
+    int elements[] = {1, 2, 3, 4};
+    int priorities[] = {5, 5, 3, 1};
+    for (int i = 0; i < 4; i++) {
+        pqInsert(pq, &elements[i], &priorities[i]);
+    }
+
+    int *first_element = pqGetFirst(pq);
+    int new_priority = 3;
+    copy_int_calls = 0;
+    ASSERT_TEST(pqChangePriority(pq, &elements[0], &priorities[0], &new_priority) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(copy_int_calls == 0, destroy);
+
+    // 1 is reinserted with priority 3 so it comes after 3 which already had that priority
+    int expected_order[] = {2, 3, 1, 4};
+    int i = 0;
+    PQ_FOREACH(int *, element, pq) {
+        ASSERT_TEST(*element == expected_order[i], destroy);
+        i++;
+    }
+    ASSERT_TEST(pqGetSize(pq) == 4, destroy);
+
+    // The same entry (and so the same element pointer) is kept
+    new_priority = 10;
+    ASSERT_TEST(pqChangePriority(pq, &elements[0], &priorities[2], &new_priority) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetFirst(pq) == first_element, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqGetFirstEntry / pqGetPriority ============= */
+bool testPQGetFirstEntryAndGetPriority() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQElement element = NULL;
+    PQElementPriority priority = NULL;
+    int elements[] = {1, 2, 1};
+    int priorities[] = {4, 9, 7};
+
+    ASSERT_TEST(pqGetFirstEntry(NULL, &element, &priority) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqGetFirstEntry(pq, NULL, &priority) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqGetFirstEntry(pq, &element, &priority) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+    ASSERT_TEST(pqGetPriority(pq, &elements[0]) == NULL, destroy);
+
+    for (int i = 0; i < 3; i++) {
+        pqInsert(pq, &elements[i], &priorities[i]);
+    }
+
+    ASSERT_TEST(pqGetFirstEntry(pq, &element, &priority) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(*(int *) element == 2 && *(int *) priority == 9, destroy);
+
+    // The first occurrence of 1 is the one with the highest priority
+    ASSERT_TEST(*(int *) pqGetPriority(pq, &elements[0]) == 7, destroy);
+    int new_priority = 1;
+    ASSERT_TEST(pqChangePriority(pq, &elements[0], pqGetPriority(pq, &elements[0]), &new_priority) == PQ_SUCCESS,
+                destroy);
+    ASSERT_TEST(*(int *) pqGetPriority(pq, &elements[0]) == 4, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqCount / pqRemoveAll ============= */
+bool testPQCountAndRemoveAll() {
+    bool result = true;
+    PQ pq = createPQ();
+    int elements[] = {1, 2, 1, 3, 1};
+    int priorities[] = {4, 9, 7, 1, 4};
+    int missing = 5;
+
+    ASSERT_TEST(pqCount(NULL, &missing) == -1, destroy);
+    ASSERT_TEST(pqRemoveAll(pq, NULL) == -1, destroy);
+    ASSERT_TEST(pqCount64(NULL, &missing) == -1, destroy);
+    ASSERT_TEST(pqRemoveAll64(pq, NULL) == -1, destroy);
+
+    for (int i = 0; i < 5; i++) {
+        pqInsert(pq, &elements[i], &priorities[i]);
+    }
+
+    ASSERT_TEST(pqCount(pq, &missing) == 0, destroy);
+    ASSERT_TEST(pqCount(pq, &elements[0]) == 3, destroy);
+    ASSERT_TEST(pqCount64(pq, &elements[0]) == 3, destroy);
+    ASSERT_TEST(pqRemoveAll64(pq, &missing) == 0, destroy);
+    ASSERT_TEST(pqRemoveAll(pq, &elements[0]) == 3, destroy);
+    ASSERT_TEST(pqCount(pq, &elements[0]) == 0, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 2, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 2, destroy);
+    ASSERT_TEST(*(int *) pqGetLast(pq) == 3, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING small queues ============= */
+bool testPQSmallQueueKeepsBookkeepingInline() {
+    bool result = true;
+    AllocationCounts counts = {0, 0};
+    PQ pq = pqCreateWithAllocator(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                                  compareIntsGeneric, allocateCounting, deallocateCounting, &counts);
+    // Only the queue itself is allocated, and the first 8 entries do not need more
+    ASSERT_TEST(counts.live_allocations == 1, destroy);
+    for (int i = 0; i < 8; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(counts.live_allocations == 1, destroy);
+
+    // Removed entries make room for the next ones, which are placed in order
+    ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveLast(pq) == PQ_SUCCESS, destroy);
+    for (int i = 20; i < 22; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(counts.live_allocations == 1, destroy);
+    int expected_order[] = {21, 20, 6, 5, 4, 3, 2, 1};
+    int index = 0;
+    PQ_FOREACH(int *, element, pq) {
+        ASSERT_TEST(*element == expected_order[index], destroy);
+        index++;
+    }
+    ASSERT_TEST(index == 8, destroy);
+    ASSERT_TEST(pqChangePriority(pq, &expected_order[5], &expected_order[5], &expected_order[0]) == PQ_SUCCESS,
+                destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 21, destroy);
+    ASSERT_TEST(*(int *) pqGetNext(pq) == 3, destroy);
+
+    // The 9th entry moves all of them to the general list, which allocates
+    for (int i = 8; i < 16; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(counts.live_allocations > 1, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 16, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 21, destroy);
+    ASSERT_TEST(*(int *) pqGetNext(pq) == 3, destroy);
+    ASSERT_TEST(*(int *) pqGetNext(pq) == 20, destroy);
+    ASSERT_TEST(*(int *) pqGetLast(pq) == 1, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqCopyParallel ============= */
+bool testPQCopyParallelKeepsOrder() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ new_pq = NULL;
+    for (int i = 0; i < 1000; i++) {
+        int priority = i % 17;
+        pqInsert(pq, &i, &priority);
+    }
+
+    ASSERT_TEST(pqCopyParallel(NULL, 4) == NULL, destroy);
+    ASSERT_TEST(pqCopyParallel(pq, 0) == NULL, destroy);
+
+    new_pq = pqCopyParallel(pq, 4);
+    ASSERT_TEST(new_pq != NULL, destroy);
+    ASSERT_TEST(pqGetSize(new_pq) == pqGetSize(pq), destroy);
+
+    int *new_pq_current_elem = pqGetFirst(new_pq);
+    PQ_FOREACH(int *, pq_current_elem, pq) {
+        ASSERT_TEST(compareIntsGeneric(pq_current_elem, new_pq_current_elem) == 0, destroy);
+        ASSERT_TEST(pq_current_elem != new_pq_current_elem, destroy);
+        new_pq_current_elem = pqGetNext(new_pq);
+    }
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(new_pq);
+    return result;
+}
+
+/* While is_failing_element_rejected is set, copyIntFailing fails for FAILING_ELEMENT */
+static bool is_failing_element_rejected;
+
+static PQElement copyIntFailing(PQElement n) {
+    if (is_failing_element_rejected && *(int *) n == FAILING_ELEMENT) {
+        return NULL;
+    }
+    return copyIntGeneric(n);
+}
+
+/* Counts the calls of freeIntCountingNull that were given NULL */
+static int null_frees_count;
+
+static void freeIntCountingNull(PQElement n) {
+    if (n == NULL) {
+        null_frees_count++;
+    }
+    free(n);
+}
+
+bool testPQCopyParallelFreesOnlyCopiedHalves() {
+    bool result = true;
+    PQ pq = pqCreate(copyIntFailing, freeIntCountingNull, equalIntsGeneric, copyIntGeneric, freeIntCountingNull,
+                     compareIntsGeneric);
+    is_failing_element_rejected = false;
+    null_frees_count = 0;
+    for (int i = 0; i < 2000; i++) {
+        int element = i == 1500 ? FAILING_ELEMENT : i;
+        ASSERT_TEST(pqInsert(pq, &element, &i) == PQ_SUCCESS, destroy);
+    }
+
+    // The copy of the failing element's priority succeeds, so only its element half is NULL
+    is_failing_element_rejected = true;
+    ASSERT_TEST(pqCopyParallel(pq, 4) == NULL, destroy);
+    ASSERT_TEST(null_frees_count == 0, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 2000, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqForEach / pqForEachParallel ============= */
+static void sumPriorities(PQElement element, PQElementPriority priority, void *context) {
+    (void) element;
+    *(long *) context += *(int *) priority;
+}
+
+typedef struct {
+    pthread_mutex_t mutex;
+    long sum;
+} SharedSum;
+
+static void sumPrioritiesLocked(PQElement element, PQElementPriority priority, void *context) {
+    (void) element;
+    SharedSum *shared_sum = context;
+    pthread_mutex_lock(&shared_sum->mutex);
+    shared_sum->sum += *(int *) priority;
+    pthread_mutex_unlock(&shared_sum->mutex);
+}
+
+bool testPQForEachAndForEachParallel() {
+    bool result = true;
+    PQ pq = createPQ();
+    long expected_sum = 0;
+    for (int i = 0; i < 1000; i++) {
+        pqInsert(pq, &i, &i);
+        expected_sum += i;
+    }
+
+    long sum = 0;
+    ASSERT_TEST(pqForEach(NULL, sumPriorities, &sum) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqForEach(pq, sumPriorities, &sum) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(sum == expected_sum, destroy);
+
+    SharedSum shared_sum;
+    pthread_mutex_init(&shared_sum.mutex, NULL);
+    shared_sum.sum = 0;
+    ASSERT_TEST(pqForEachParallel(pq, sumPrioritiesLocked, &shared_sum, 0) == PQ_ERROR, destroy_mutex);
+    ASSERT_TEST(pqForEachParallel(pq, sumPrioritiesLocked, &shared_sum, 4) == PQ_SUCCESS, destroy_mutex);
+    ASSERT_TEST(shared_sum.sum == expected_sum, destroy_mutex);
+
+    destroy_mutex:
+    pthread_mutex_destroy(&shared_sum.mutex);
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqEnableMembershipFilter ============= */
+static uint64_t hashIntGeneric(PQElement n) {
+    return (uint64_t) *(int *) n;
+}
+
+bool testPQMembershipFilter() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ new_pq = NULL;
+    PQFilterStats stats;
+    for (int i = 0; i < 100; i += 2) {
+        pqInsert(pq, &i, &i);
+    }
+
+    ASSERT_TEST(pqGetFilterStats(pq, &stats) == PQ_ERROR, destroy);
+    ASSERT_TEST(pqEnableMembershipFilter(pq, NULL, 1000) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqEnableMembershipFilter(pq, hashIntGeneric, 0) == PQ_ERROR, destroy);
+    ASSERT_TEST(pqEnableMembershipFilter(pq, hashIntGeneric, 1000) == PQ_SUCCESS, destroy);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TEST(pqContains(pq, &i) == (i % 2 == 0), destroy);
+    }
+    ASSERT_TEST(pqGetFilterStats(pq, &stats) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(stats.queries == 100, destroy);
+    ASSERT_TEST(stats.definite_misses + stats.false_positives == 50, destroy);
+    ASSERT_TEST(stats.definite_misses > 0, destroy);
+    ASSERT_TEST(stats.false_positive_rate < 0.5, destroy);
+
+    // The filter follows removals and insertions
+    int element = 42;
+    ASSERT_TEST(pqRemoveAll(pq, &element) == 1, destroy);
+    ASSERT_TEST(!pqContains(pq, &element), destroy);
+    element = 43;
+    pqInsert(pq, &element, &element);
+    ASSERT_TEST(pqCount(pq, &element) == 1, destroy);
+
+    new_pq = pqCopy(pq);
+    ASSERT_TEST(new_pq != NULL, destroy);
+    ASSERT_TEST(pqContains(new_pq, &element), destroy);
+    ASSERT_TEST(pqGetFilterStats(new_pq, &stats) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(stats.queries == 1, destroy);
+
+    pqClear(pq);
+    ASSERT_TEST(!pqContains(pq, &element), destroy);
+    ASSERT_TEST(pqGetFilterStats(pq, &stats) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(stats.definite_misses > 0, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(new_pq);
+    return result;
+}
+
+
+/* ============= TESTING pqInsert ordering ============= */
+bool testPQInsertKeepsInsertionOrderFromBothEnds() {
+    bool result = true;
+    PQ pq = createPQ();
+    // Non-increasing priorities (appended at the end), then increasing ones (inserted at the start),
+    // then ties with existing priorities in the middle
+    int elements[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    int priorities[] = {5, 5, 3, 1, 7, 9, 3, 5};
+    for (int i = 0; i < 8; i++) {
+        pqInsert(pq, &elements[i], &priorities[i]);
+    }
+
+    int expected_order[] = {6, 5, 1, 2, 8, 3, 7, 4};
+    int i = 0;
+    PQ_FOREACH(int *, element, pq) {
+        ASSERT_TEST(*element == expected_order[i], destroy);
+        i++;
+    }
+    ASSERT_TEST(i == 8, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
+/* ============= TESTING pqStartTrace ============= */
+bool testPQTraceRecordsOperations() {
+    bool result = true;
+    PQ pq = createPQ();
+    FILE *trace_file = tmpfile();
+    ASSERT_TEST(trace_file != NULL, destroy);
+    ASSERT_TEST(pqStartTrace(pq, NULL, INT_SERIALIZER_ID, writeIntGeneric, writeIntGeneric) == PQ_NULL_ARGUMENT,
+                destroy);
+    ASSERT_TEST(pqStopTrace(pq) == PQ_ERROR, destroy);
+    ASSERT_TEST(pqStartTrace(pq, trace_file, INT_SERIALIZER_ID, writeIntGeneric, writeIntGeneric) == PQ_SUCCESS,
+                destroy);
+
+    int element = 3, priority = 7, new_priority = 9;
+    ASSERT_TEST(pqInsert(pq, &element, &priority) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqChangePriority(pq, &element, &priority, &new_priority) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqInsert(pq, NULL, &priority) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 1, destroy);
+    PQElement first_element;
+    PQElementPriority first_priority;
+    ASSERT_TEST(pqGetFirstEntry(pq, &first_element, &first_priority) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetLast(pq) != NULL, destroy);
+    ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqStopTrace(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+
+    // The header comes first, with the serializer id most significant byte first
+    rewind(trace_file);
+    unsigned char expected_header[] = {'P', 'Q', 'T', 'R', PQ_TRACE_VERSION, 0x49, 0x4E, 0x54, 0x34};
+    for (int i = 0; i < (int) sizeof(expected_header); i++) {
+        ASSERT_TEST(fgetc(trace_file) == expected_header[i], destroy);
+    }
+
+    // Only the valid calls before pqStopTrace are recorded, each with its arguments
+    int expected[] = {PQ_TRACE_INSERT, element, priority, PQ_TRACE_CHANGE_PRIORITY, element, priority, new_priority,
+                      PQ_TRACE_GET_SIZE, PQ_TRACE_GET_FIRST_ENTRY, PQ_TRACE_GET_LAST, PQ_TRACE_REMOVE_FIRST};
+    bool is_operation[] = {true, false, false, true, false, false, false, true, true, true, true};
+    for (int i = 0; i < (int) (sizeof(expected) / sizeof(*expected)); i++) {
+        int value;
+        if (is_operation[i]) {
+            value = fgetc(trace_file);
+        } else {
+            ASSERT_TEST(fread(&value, sizeof(value), 1, trace_file) == 1, destroy);
+        }
+        ASSERT_TEST(value == expected[i], destroy);
+    }
+    ASSERT_TEST(fgetc(trace_file) == EOF, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    if (trace_file != NULL) {
+        fclose(trace_file);
+    }
+    return result;
+}
+
+
+/* ============= TESTING list node pool ============= */
+bool testPQListNodesAreRecycled() {
+    bool result = true;
+    AllocationCounts counts = {0, 0};
+    PQ pq = pqCreateWithAllocator(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                                  compareIntsGeneric, allocateCounting, deallocateCounting, &counts);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+
+    // Every insertion allocates its CombinedElement, but removed list nodes are reused instead of reallocated
+    int allocations_before_churn = counts.allocations_count;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(counts.allocations_count - allocations_before_churn <= 1000, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 100, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+
 /* ============= Course given tests ============= */
 bool testPQCreateDestroy() {
     bool result = true;
@@ -834,7 +1658,29 @@ bool (*tests[])(void) = {
         testPQGetNextStandardTest,
         testPQGetNextTraversesTheQueueCorrectlyByPriority,
         testPQClearStandardTest,
-        testPQClearWorksOkayOnEmptyQueue
+        testPQClearWorksOkayOnEmptyQueue,
+        testPQGetLastEmptyQueueReturnNull,
+        testPQRemoveLastRemovesLowestPriorityLastInsertedFirst,
+        testPQCreateBoundedIllegalCapacity,
+        testPQBoundedKeepsBestAndRejectsWithoutCopying,
+        testPQCreateExternalIllegalArguments,
+        testPQExternalRemovesInSameOrderAsInMemoryQueue,
+        testPQExternalMergesManyRuns,
+        testPQExternalKeepsEntriesWhenMergesFail,
+        testPQExternalRejectsLookupAndIteration,
+        testPQCreateWithAllocatorUsesAllocatorForAllBookkeeping,
+        testPQClearKeepCapacityReusesStorage,
+        testPQChangePriorityDoesNotCopyElement,
+        testPQGetFirstEntryAndGetPriority,
+        testPQCountAndRemoveAll,
+        testPQSmallQueueKeepsBookkeepingInline,
+        testPQCopyParallelKeepsOrder,
+        testPQCopyParallelFreesOnlyCopiedHalves,
+        testPQForEachAndForEachParallel,
+        testPQMembershipFilter,
+        testPQInsertKeepsInsertionOrderFromBothEnds,
+        testPQTraceRecordsOperations,
+        testPQListNodesAreRecycled
 };
 
 const char *testNames[] = {
@@ -876,7 +1722,29 @@ const char *testNames[] = {
         "testPQGetNextStandardTest",
         "testPQGetNextTraversesTheQueueCorrectlyByPriority",
         "testPQClearStandardTest",
-        "testPQClearWorksOkayOnEmptyQueue"
+        "testPQClearWorksOkayOnEmptyQueue",
+        "testPQGetLastEmptyQueueReturnNull",
+        "testPQRemoveLastRemovesLowestPriorityLastInsertedFirst",
+        "testPQCreateBoundedIllegalCapacity",
+        "testPQBoundedKeepsBestAndRejectsWithoutCopying",
+        "testPQCreateExternalIllegalArguments",
+        "testPQExternalRemovesInSameOrderAsInMemoryQueue",
+        "testPQExternalMergesManyRuns",
+        "testPQExternalKeepsEntriesWhenMergesFail",
+        "testPQExternalRejectsLookupAndIteration",
+        "testPQCreateWithAllocatorUsesAllocatorForAllBookkeeping",
+        "testPQClearKeepCapacityReusesStorage",
+        "testPQChangePriorityDoesNotCopyElement",
+        "testPQGetFirstEntryAndGetPriority",
+        "testPQCountAndRemoveAll",
+        "testPQSmallQueueKeepsBookkeepingInline",
+        "testPQCopyParallelKeepsOrder",
+        "testPQCopyParallelFreesOnlyCopiedHalves",
+        "testPQForEachAndForEachParallel",
+        "testPQMembershipFilter",
+        "testPQInsertKeepsInsertionOrderFromBothEnds",
+        "testPQTraceRecordsOperations",
+        "testPQListNodesAreRecycled"
 };
 
 const char *testFailDescriptions[] = {
@@ -918,11 +1786,33 @@ const char *testFailDescriptions[] = {
         "Please refer to the testing code at function: testPQGetNextStandardTest",
         "Please refer to the testing code at function: testPQGetNextTraversesTheQueueCorrectlyByPriority",
         "Please refer to the testing code at function: testPQClearStandardTest",
-        "Please refer to the testing code at function: testPQClearWorksOkayOnEmptyQueue"
+        "Please refer to the testing code at function: testPQClearWorksOkayOnEmptyQueue",
+        "Please refer to the testing code at function: testPQGetLastEmptyQueueReturnNull",
+        "Please refer to the testing code at function: testPQRemoveLastRemovesLowestPriorityLastInsertedFirst",
+        "Please refer to the testing code at function: testPQCreateBoundedIllegalCapacity",
+        "Please refer to the testing code at function: testPQBoundedKeepsBestAndRejectsWithoutCopying",
+        "Please refer to the testing code at function: testPQCreateExternalIllegalArguments",
+        "Please refer to the testing code at function: testPQExternalRemovesInSameOrderAsInMemoryQueue",
+        "Please refer to the testing code at function: testPQExternalMergesManyRuns",
+        "Please refer to the testing code at function: testPQExternalKeepsEntriesWhenMergesFail",
+        "Please refer to the testing code at function: testPQExternalRejectsLookupAndIteration",
+        "Please refer to the testing code at function: testPQCreateWithAllocatorUsesAllocatorForAllBookkeeping",
+        "Please refer to the testing code at function: testPQClearKeepCapacityReusesStorage",
+        "Please refer to the testing code at function: testPQChangePriorityDoesNotCopyElement",
+        "Please refer to the testing code at function: testPQGetFirstEntryAndGetPriority",
+        "Please refer to the testing code at function: testPQCountAndRemoveAll",
+        "Please refer to the testing code at function: testPQSmallQueueKeepsBookkeepingInline",
+        "Please refer to the testing code at function: testPQCopyParallelKeepsOrder",
+        "Please refer to the testing code at function: testPQCopyParallelFreesOnlyCopiedHalves",
+        "Please refer to the testing code at function: testPQForEachAndForEachParallel",
+        "Please refer to the testing code at function: testPQMembershipFilter",
+        "Please refer to the testing code at function: testPQInsertKeepsInsertionOrderFromBothEnds",
+        "Please refer to the testing code at function: testPQTraceRecordsOperations",
+        "Please refer to the testing code at function: testPQListNodesAreRecycled"
 };
 
 
-#define NUMBER_TESTS 39
+#define NUMBER_TESTS 61
 
 int main(int argc, char **argv) {
     if (argc == 1) {
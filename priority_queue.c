@@ -1,32 +1,245 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
 #include "priority_queue.h"
 #include "double_linked_list.h"
 
 #define LIST_NULL_NO_SIZE -1
+#define UNBOUNDED_CAPACITY 0
+#define EXTERNAL_MERGE_FAN_IN 8
+#define EXTERNAL_MAX_RUNS 32
+#define EXTERNAL_BYTES_PER_ENTRY 64
+#define EXTERNAL_MIN_READ_AHEAD_BYTES 256
+#define EXTERNAL_MAX_READ_AHEAD_BYTES (1 << 20)
+#define EXTERNAL_SOURCE_NONE -2
+#define EXTERNAL_SOURCE_MEMORY -1
+#define SMALL_QUEUE_CAPACITY 8
+#define SMALL_INDEX_NONE -1
+#define PARALLEL_MIN_ENTRIES_PER_THREAD 256
+#define FILTER_HASHES_COUNT 3
+#define FILTER_COUNTER_MAX 255
+
+typedef struct ExternalStorage_t *ExternalStorage;
+
+/* A counting Bloom filter of the elements in the queue. Every element increments FILTER_HASHES_COUNT counters,
+ * so an element with a zero counter is definitely not in the queue. A counter that reached FILTER_COUNTER_MAX
+ * is never decremented again, since it may count more elements than it can hold */
+typedef struct {
+    HashPQElement hash_element;
+    unsigned char *counters;
+    int counters_count;
+    long queries;
+    long definite_misses;
+    long false_positives;
+} *MembershipFilter;
+
+/* Spare CombinedElements that are kept for reuse (see pqClearKeepCapacity) are chained through their pq_element */
+typedef struct CombinedElement_t {
+    PQElement pq_element;
+    PQElementPriority pq_element_priority;
+} *CombinedElement;
 
+/* A queue created by pqCreate starts small: its entries are kept in order in small_entries, an array at the end
+ * of the queue struct, and small_iterator is the index of the iterator (or SMALL_INDEX_NONE). Entries are found and
+ * placed by a linear scan, which beats following list nodes at this size. The elements_list is NULL until the
+ * SMALL_QUEUE_CAPACITY + 1-th entry is inserted, when the entries are moved to it and the queue stays a general
+ * one until pqClear empties it. Other queues (bounded, external and copies of general queues) are allocated
+ * without small_entries (has_small_entries is false) and start with an elements_list */
 struct PriorityQueue_t {
     LinkedList elements_list;
     LinkedNode iterator;
+    bool has_small_entries;
+    int small_size;
+    int small_iterator;
+    int capacity;
+    ExternalStorage external;
+    CombinedElement spare_combined_elements;
+    MembershipFilter filter;
+    FILE *trace_file;
+    WritePQElement trace_write_element;
+    WritePQElementPriority trace_write_priority;
     CopyPQElement copy_element;
     FreePQElement free_element;
     EqualPQElements equal_elements;
     CopyPQElementPriority copy_priority;
     FreePQElementPriority free_priority;
     ComparePQElementPriorities compare_priorities;
+    AllocateFunction allocate;
+    DeallocateFunction deallocate;
+    void *allocator_context;
+    struct CombinedElement_t small_entries[];
 };
 
 
+/* A sorted run of entries that was spilled to a temporary file. head is the next entry of the run, which
+ * was already read back to memory, and remaining_size is the amount of entries left in the file after it
+ * (while the run is written, the amount of entries written so far). level is 0 for a run spilled from the
+ * elements_list, and one more than the levels of the runs it was merged from otherwise */
 typedef struct {
-    PQElement pq_element;
-    PQElementPriority pq_element_priority;
-} *CombinedElement;
+    FILE *file;
+    char *read_ahead_buffer;
+    CombinedElement head;
+    int64_t remaining_size;
+    int level;
+} *SpilledRun;
+
+/* The disk part of an external-memory queue. A quarter of memory_budget goes to the read-ahead buffers of the
+ * runs (counting EXTERNAL_BYTES_PER_ENTRY bytes per entry, split between EXTERNAL_MAX_RUNS runs), and the
+ * elements_list holds at most list_budget entries, the rest of it. Older entries are kept in the runs (ordered
+ * from the oldest run to the newest), which are merged so there are always fewer than EXTERNAL_MAX_RUNS of them.
+ * spilled_size counts the entries in all the runs, including their heads */
+struct ExternalStorage_t {
+    int memory_budget;
+    int list_budget;
+    size_t read_ahead_bytes;
+    SpilledRun *runs;
+    int runs_count;
+    int64_t spilled_size;
+    WritePQElement write_element;
+    ReadPQElement read_element;
+    WritePQElementPriority write_priority;
+    ReadPQElementPriority read_priority;
+};
+
+/* The allocation function used by queues that were created without an allocator */
+static void *defaultAllocate(size_t size, void *context) {
+    (void) context;
+    return malloc(size);
+}
+
+/* The deallocation function used by queues that were created without an allocator */
+static void defaultDeallocate(void *memory, void *context) {
+    (void) context;
+    free(memory);
+}
+
+/* Allocates size bytes using the allocator of the queue */
+static void *pqAllocate(PriorityQueue queue, size_t size) {
+    return queue->allocate(size, queue->allocator_context);
+}
+
+/* Frees memory that was allocated with pqAllocate */
+static void pqDeallocate(PriorityQueue queue, void *memory) {
+    queue->deallocate(memory, queue->allocator_context);
+}
+
+/* Returns the index of the hash_number-th counter of an element in the filter (double hashing). The step is
+ * the hash scrambled by the splitmix64 finalizer, so it is well spread even if only the low bits of the hash
+ * are used */
+static int getFilterCounterIndex(MembershipFilter filter, uint64_t hash, int hash_number) {
+    uint64_t step = hash + 0x9E3779B97F4A7C15ULL;
+    step = (step ^ (step >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    step = (step ^ (step >> 27)) * 0x94D049BB133111EBULL;
+    step = (step ^ (step >> 31)) | 1;
+    return (int) ((hash + hash_number * step) % (uint64_t) filter->counters_count);
+}
+
+/* Adds (if is_added is true) or removes an element from the queue's filter, if it has one */
+static void updateFilter(PriorityQueue queue, PQElement element, bool is_added) {
+    MembershipFilter filter = queue->filter;
+    if (filter == NULL) {
+        return;
+    }
+
+    uint64_t hash = filter->hash_element(element);
+    for (int i = 0; i < FILTER_HASHES_COUNT; i++) {
+        unsigned char *counter = &filter->counters[getFilterCounterIndex(filter, hash, i)];
+        if (*counter == FILTER_COUNTER_MAX) {
+            continue;
+        }
+        if (is_added) {
+            (*counter)++;
+        } else if (*counter > 0) {
+            (*counter)--;
+        }
+    }
+}
+
+/* Returns false if the queue's filter shows that element is definitely not in the queue, true otherwise.
+ * If is_counted is true the query is counted in the filter's statistics */
+static bool filterMayContain(PriorityQueue queue, PQElement element, bool is_counted) {
+    MembershipFilter filter = queue->filter;
+    if (filter == NULL) {
+        return true;
+    }
+
+    uint64_t hash = filter->hash_element(element);
+    bool may_contain = true;
+    for (int i = 0; i < FILTER_HASHES_COUNT && may_contain; i++) {
+        may_contain = filter->counters[getFilterCounterIndex(filter, hash, i)] != 0;
+    }
+
+    if (is_counted) {
+        filter->queries++;
+        if (!may_contain) {
+            filter->definite_misses++;
+        }
+    }
+    return may_contain;
+}
+
+/* Counts a query that passed the queue's filter but did not find the element in the queue */
+static void countFilterFalsePositive(PriorityQueue queue) {
+    if (queue->filter != NULL) {
+        queue->filter->false_positives++;
+    }
+}
+
+/* Frees the queue's filter, if it has one */
+static void destroyFilter(PriorityQueue queue) {
+    if (queue->filter == NULL) {
+        return;
+    }
+    queue->deallocate(queue->filter->counters, queue->allocator_context);
+    queue->deallocate(queue->filter, queue->allocator_context);
+    queue->filter = NULL;
+}
+
+/* Appends a record of an operation to the queue's trace file, if it is traced. element and the priorities are
+ * the arguments of the operation, the ones it does not have are NULL. When a write fails the tracing stops, so a
+ * broken trace never fails the operation itself */
+static void traceOperation(PriorityQueue queue, PQTraceOperation operation, PQElement element,
+                           PQElementPriority priority, PQElementPriority second_priority) {
+    if (queue->trace_file == NULL) {
+        return;
+    }
+
+    bool is_written = fputc(operation, queue->trace_file) != EOF;
+    if (is_written && element != NULL) {
+        is_written = queue->trace_write_element(element, queue->trace_file);
+    }
+    if (is_written && priority != NULL) {
+        is_written = queue->trace_write_priority(priority, queue->trace_file);
+    }
+    if (is_written && second_priority != NULL) {
+        is_written = queue->trace_write_priority(second_priority, queue->trace_file);
+    }
 
+    if (!is_written) {
+        queue->trace_file = NULL;
+    }
+}
+
+/* Writes the header of a trace file (see PQ_TRACE_MAGIC). Returns false if writing failed */
+static bool writeTraceHeader(FILE *trace_file, uint32_t serializer_id) {
+    if (fwrite(PQ_TRACE_MAGIC, 1, PQ_TRACE_MAGIC_LENGTH, trace_file) != PQ_TRACE_MAGIC_LENGTH ||
+        fputc(PQ_TRACE_VERSION, trace_file) == EOF) {
+        return false;
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        if (fputc((serializer_id >> shift) & 0xFF, trace_file) == EOF) {
+            return false;
+        }
+    }
+    return true;
+}
 
 /* Gets a queue and element and returns the first node in the queue's
  * elements_list that has its element value equal to the element parameter */
 static LinkedNode getFirstOccurenceByElement(PriorityQueue queue, PQElement element) {
-    if (queue == NULL || element == NULL) {
+    if (queue == NULL || element == NULL || !filterMayContain(queue, element, true)) {
         return NULL;
     }
 
@@ -36,6 +249,7 @@ static LinkedNode getFirstOccurenceByElement(PriorityQueue queue, PQElement elem
         }
     }
 
+    countFilterFalsePositive(queue);
     return NULL;
 }
 
@@ -43,7 +257,7 @@ static LinkedNode getFirstOccurenceByElement(PriorityQueue queue, PQElement elem
  * elements_list that has its element and priority values equal to the element and priority parameters */
 static LinkedNode
 getFirstOccurenceByElementAndPriority(PriorityQueue queue, PQElement element, PQElementPriority priority) {
-    if (queue == NULL || element == NULL || priority == NULL) {
+    if (queue == NULL || element == NULL || priority == NULL || !filterMayContain(queue, element, false)) {
         return NULL;
     }
 
@@ -64,33 +278,44 @@ getFirstOccurenceByElementAndPriority(PriorityQueue queue, PQElement element, PQ
 }
 
 /* Gets a queue and a priority and gets the smallest node in the
- * queues elements_list that it's priority is bigger than the priority parameter */
-static LinkedNode getPreviousBiggestNode(PriorityQueue queue, PQElementPriority priority) {
+ * queues elements_list that it's priority is bigger than the priority parameter (or equal to it, since the new node
+ * goes after the older ones), not counting ignored_node (which may be NULL). Most insertions come in non-increasing
+ * priority order, so the search starts at the tail of the list and goes backwards, and a priority bigger than the
+ * first one is answered without a search */
+static LinkedNode getPreviousBiggestNode(PriorityQueue queue, PQElementPriority priority, LinkedNode ignored_node) {
     if (queue == NULL || priority == NULL) {
         return NULL;
     }
 
-    LinkedNode current_node = listGetFirst(queue->elements_list);
-    LinkedNode last_node = NULL;
-    while (current_node != NULL) {
-        PQElementPriority current_priority = ((CombinedElement) listGetData(current_node))->pq_element_priority;
+    LinkedNode first_node = listGetFirst(queue->elements_list);
+    if (first_node == ignored_node && first_node != NULL) {
+        first_node = listGetNext(first_node);
+    }
+    if (first_node == NULL ||
+        queue->compare_priorities(((CombinedElement) listGetData(first_node))->pq_element_priority, priority) < 0) {
+        return NULL;
+    }
 
-        if (queue->compare_priorities(current_priority, priority) < 0) {
-            return last_node;
+    LinkedNode current_node = listGetLast(queue->elements_list);
+    while (current_node != NULL) {
+        if (current_node != ignored_node) {
+            PQElementPriority current_priority = ((CombinedElement) listGetData(current_node))->pq_element_priority;
+            if (queue->compare_priorities(current_priority, priority) >= 0) {
+                return current_node;
+            }
         }
 
-        last_node = current_node;
-        current_node = listGetNext(current_node);
+        current_node = listGetPrev(current_node);
     }
 
-    return last_node;
+    return NULL;
 }
 
 /* Gets a CombinedElement and frees all the data linked to it (the pointer itself and both the element and priority it contains) */
 static void destroyCombinedElement(PriorityQueue queue, CombinedElement combined_element) {
     queue->free_element(combined_element->pq_element);
     queue->free_priority(combined_element->pq_element_priority);
-    free(combined_element);
+    pqDeallocate(queue, combined_element);
 }
 
 /* Gets a list node from the elements_list and removes it (freeing the CombinedElement and both of its fields) */
@@ -98,15 +323,37 @@ static PriorityQueueResult pqRemoveByNode(PriorityQueue queue, LinkedNode target
     if (queue == NULL || target_node == NULL) {
         return PQ_NULL_ARGUMENT;
     }
-    destroyCombinedElement(queue, listGetData(target_node));
+    CombinedElement combined_element = listGetData(target_node);
+    updateFilter(queue, combined_element->pq_element, false);
+    destroyCombinedElement(queue, combined_element);
     listRemove(queue->elements_list, target_node);
     queue->iterator = NULL;
     return PQ_SUCCESS;
 }
 
+/* Allocates memory for a CombinedElement, reusing a spare one if the queue has one */
+static CombinedElement allocateCombinedElement(PriorityQueue queue) {
+    CombinedElement combined_element = queue->spare_combined_elements;
+    if (combined_element == NULL) {
+        return pqAllocate(queue, sizeof(*combined_element));
+    }
+
+    queue->spare_combined_elements = combined_element->pq_element;
+    return combined_element;
+}
+
+/* Frees all the spare CombinedElements of the queue */
+static void destroySpareCombinedElements(PriorityQueue queue) {
+    while (queue->spare_combined_elements != NULL) {
+        CombinedElement combined_element = queue->spare_combined_elements;
+        queue->spare_combined_elements = combined_element->pq_element;
+        pqDeallocate(queue, combined_element);
+    }
+}
+
 /* Gets an element and a priority and creates a CombinedElement that holds the both of them together */
 static CombinedElement createCombinedElement(PriorityQueue queue, PQElement element, PQElementPriority priority) {
-    CombinedElement combined_element = malloc(sizeof(*combined_element));
+    CombinedElement combined_element = allocateCombinedElement(queue);
     if (combined_element == NULL) {
         return NULL;
     }
@@ -121,125 +368,146 @@ static CombinedElement createCombinedElement(PriorityQueue queue, PQElement elem
     return combined_element;
 }
 
-/* Gets a queue and returns a copy of its elements_list */
-static LinkedList copyElementsList(PriorityQueue queue) {
-    LinkedList list = queue->elements_list;
-    LinkedList new_list = listCreate();
-
-    LinkedNode last_node = NULL;
-    LIST_FOREACH(list, node) {
-        CombinedElement current_combined_element = listGetData(node);
-        CombinedElement new_combined_element = createCombinedElement(queue, current_combined_element->pq_element,
-                                                                     current_combined_element->pq_element_priority);
-        if (new_combined_element == NULL) {
-            listDestroy(new_list);
-            return NULL;
-        }
+/* Returns whether the queue keeps its entries in small_entries */
+static bool isSmall(PriorityQueue queue) {
+    return queue->elements_list == NULL;
+}
 
-        if (last_node == NULL) {
-            last_node = listInsertStart(new_list, new_combined_element);
-        } else {
-            last_node = listInsertAfter(new_list, last_node, new_combined_element);
-        }
+/* Returns the index of the first entry of a small queue that has its element equal to element and, unless priority
+ * is NULL, its priority equal to priority. Returns SMALL_INDEX_NONE if there is no such entry.
+ * As in getFirstOccurenceByElement, only a lookup by element alone is counted in the filter's statistics */
+static int getSmallEntryIndex(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    bool is_counted = priority == NULL;
+    if (!filterMayContain(queue, element, is_counted)) {
+        return SMALL_INDEX_NONE;
+    }
 
-        if (last_node == NULL) {
-            listDestroy(new_list);
-            return NULL;
+    for (int i = 0; i < queue->small_size; i++) {
+        struct CombinedElement_t *entry = &queue->small_entries[i];
+        if (queue->equal_elements(entry->pq_element, element) &&
+            (priority == NULL || queue->compare_priorities(entry->pq_element_priority, priority) == 0)) {
+            return i;
         }
     }
 
-    return new_list;
-}
-
-
-PriorityQueue pqCreate(CopyPQElement copy_element,
-                       FreePQElement free_element,
-                       EqualPQElements equal_elements,
-                       CopyPQElementPriority copy_priority,
-                       FreePQElementPriority free_priority,
-                       ComparePQElementPriorities compare_priorities) {
-    if (copy_element == NULL || free_element == NULL || equal_elements == NULL || copy_priority == NULL ||
-        free_priority == NULL || compare_priorities == NULL) {
-        return NULL;
+    if (is_counted) {
+        countFilterFalsePositive(queue);
     }
+    return SMALL_INDEX_NONE;
+}
 
-    PriorityQueue queue = malloc(sizeof(struct PriorityQueue_t));
+/* Takes the entry at index out of a small queue, moving the entries after it back, and returns it */
+static struct CombinedElement_t takeSmallEntry(PriorityQueue queue, int index) {
+    struct CombinedElement_t entry = queue->small_entries[index];
+    memmove(&queue->small_entries[index], &queue->small_entries[index + 1],
+            (queue->small_size - index - 1) * sizeof(entry));
+    queue->small_size--;
+    queue->small_iterator = SMALL_INDEX_NONE;
+    return entry;
+}
 
-    LinkedList element_list = listCreate();
-    if (queue == NULL || element_list == NULL) {
-        free(queue);
-        free(element_list);
-        return NULL;
+/* Puts an entry in its place in a small queue that has room for it, after the entries whose priorities are not
+ * lower. As in getPreviousBiggestNode, the scan starts at the last entry */
+static void placeSmallEntry(PriorityQueue queue, struct CombinedElement_t entry) {
+    int index = queue->small_size;
+    while (index > 0 &&
+           queue->compare_priorities(queue->small_entries[index - 1].pq_element_priority,
+                                     entry.pq_element_priority) < 0) {
+        index--;
     }
 
-    queue->elements_list = element_list;
-    queue->iterator = NULL;
-    queue->copy_element = copy_element;
-    queue->free_element = free_element;
-    queue->equal_elements = equal_elements;
-    queue->copy_priority = copy_priority;
-    queue->free_priority = free_priority;
-    queue->compare_priorities = compare_priorities;
+    memmove(&queue->small_entries[index + 1], &queue->small_entries[index],
+            (queue->small_size - index) * sizeof(entry));
+    queue->small_entries[index] = entry;
+    queue->small_size++;
+    queue->small_iterator = SMALL_INDEX_NONE;
+}
 
-    return queue;
+/* Removes the entry at index from a small queue, freeing its element and priority */
+static void removeSmallEntry(PriorityQueue queue, int index) {
+    struct CombinedElement_t entry = takeSmallEntry(queue, index);
+    updateFilter(queue, entry.pq_element, false);
+    queue->free_element(entry.pq_element);
+    queue->free_priority(entry.pq_element_priority);
 }
 
-void pqDestroy(PriorityQueue queue) {
-	if (queue == NULL) {
-        return;
+/* Inserts a copy of element with the given priority to its place in a small queue that has room for it */
+static PriorityQueueResult insertSmallEntry(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    struct CombinedElement_t entry;
+    entry.pq_element = queue->copy_element(element);
+    entry.pq_element_priority = entry.pq_element == NULL ? NULL : queue->copy_priority(priority);
+    if (entry.pq_element_priority == NULL) {
+        if (entry.pq_element != NULL) {
+            queue->free_element(entry.pq_element);
+        }
+        return PQ_OUT_OF_MEMORY;
     }
-    pqClear(queue);
-    free(queue->elements_list);
-    free(queue);
+
+    placeSmallEntry(queue, entry);
+    updateFilter(queue, entry.pq_element, true);
+    return PQ_SUCCESS;
 }
 
-PriorityQueue pqCopy(PriorityQueue queue) {
-    if (queue == NULL) {
-        return NULL;
+/* Moves the entries of a small queue to a new elements_list, which the queue uses from then on.
+ * Returns false if an allocation failed, in which case the queue stays small and is not changed */
+static bool leaveSmallMode(PriorityQueue queue) {
+    LinkedList elements_list = listCreateWithAllocator(queue->allocate, queue->deallocate, queue->allocator_context);
+    if (elements_list == NULL) {
+        return false;
     }
 
-    PriorityQueue new_queue = pqCreate(queue->copy_element, queue->free_element, queue->equal_elements,
-                                       queue->copy_priority, queue->free_priority, queue->compare_priorities);
-    LinkedList new_list = copyElementsList(queue);
-    if (new_queue == NULL || new_list == NULL) {
-        listDestroy(new_list);
-        pqDestroy(new_queue);
-        return NULL;
+    for (int i = 0; i < queue->small_size; i++) {
+        CombinedElement combined_element = allocateCombinedElement(queue);
+        if (combined_element != NULL && listInsertEnd(elements_list, combined_element) == NULL) {
+            pqDeallocate(queue, combined_element);
+            combined_element = NULL;
+        }
+        if (combined_element == NULL) {
+            // The element and priority are still owned by small_entries, so only the bookkeeping is freed
+            LIST_FOREACH(elements_list, node) {
+                pqDeallocate(queue, listGetData(node));
+            }
+            listDestroy(elements_list);
+            return false;
+        }
+        *combined_element = queue->small_entries[i];
     }
 
-    listDestroy(new_queue->elements_list);
-    new_queue->elements_list = new_list;
-
-    new_queue->iterator = NULL;
+    queue->elements_list = elements_list;
+    queue->small_size = 0;
+    queue->small_iterator = SMALL_INDEX_NONE;
     queue->iterator = NULL;
-    return new_queue;
+    return true;
 }
 
-int pqGetSize(PriorityQueue queue) {
-    if (queue == NULL) {
-        return LIST_NULL_NO_SIZE;
+/* Changes the priority of the first entry of a small queue with element and old_priority, as pqChangePriority */
+static PriorityQueueResult changeSmallEntryPriority(PriorityQueue queue, PQElement element,
+                                                    PQElementPriority old_priority, PQElementPriority new_priority) {
+    int index = getSmallEntryIndex(queue, element, old_priority);
+    if (index == SMALL_INDEX_NONE) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
     }
-    return listGetSize(queue->elements_list);
-}
 
-bool pqContains(PriorityQueue queue, PQElement element) {
-    if (queue == NULL || element == NULL) {
-        return false;
+    PQElementPriority new_priority_copy = queue->copy_priority(new_priority);
+    if (new_priority_copy == NULL) {
+        return PQ_OUT_OF_MEMORY;
     }
-    return getFirstOccurenceByElement(queue, element) != NULL;
-}
 
-PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority) {
-    if (queue == NULL || element == NULL || priority == NULL) {
-        return PQ_NULL_ARGUMENT;
-    }
+    struct CombinedElement_t entry = takeSmallEntry(queue, index);
+    queue->free_priority(entry.pq_element_priority);
+    entry.pq_element_priority = new_priority_copy;
+    placeSmallEntry(queue, entry);
+    return PQ_SUCCESS;
+}
 
+/* Inserts a copy of element with the given priority to its place in the elements_list, ignoring the queue's capacity */
+static PriorityQueueResult insertWithoutEviction(PriorityQueue queue, PQElement element, PQElementPriority priority) {
     CombinedElement combined_element = createCombinedElement(queue, element, priority);
     if (combined_element == NULL) {
         return PQ_OUT_OF_MEMORY;
     }
 
-    LinkedNode previous_biggest_node = getPreviousBiggestNode(queue, priority);
+    LinkedNode previous_biggest_node = getPreviousBiggestNode(queue, priority, NULL);
     LinkedNode inserted_node = NULL;
     if (previous_biggest_node == NULL) {
         inserted_node = listInsertStart(queue->elements_list, combined_element);
@@ -252,99 +520,1392 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
         return PQ_OUT_OF_MEMORY;
     }
 
+    updateFilter(queue, combined_element->pq_element, true);
     queue->iterator = NULL;
     return PQ_SUCCESS;
 }
 
-PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
-                                     PQElementPriority old_priority, PQElementPriority new_priority) {
-    if (queue == NULL || element == NULL || old_priority == NULL || new_priority == NULL) {
-        return PQ_NULL_ARGUMENT;
+/* Frees the element and priority of every entry in the queue (in small_entries or the elements_list) in one sweep
+ * and then empties it.
+ * If keep_capacity is true the CombinedElements and the list nodes are kept for reuse by later insertions,
+ * otherwise they are freed together with the spare ones */
+static void clearElementsList(PriorityQueue queue, bool keep_capacity) {
+    for (int i = 0; i < queue->small_size; i++) {
+        queue->free_element(queue->small_entries[i].pq_element);
+        queue->free_priority(queue->small_entries[i].pq_element_priority);
     }
+    queue->small_size = 0;
+    queue->small_iterator = SMALL_INDEX_NONE;
 
-    LinkedNode target_node = getFirstOccurenceByElementAndPriority(queue, element, old_priority);
-    if (target_node == NULL) {
-        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    LIST_FOREACH(queue->elements_list, node) {
+        CombinedElement combined_element = listGetData(node);
+        queue->free_element(combined_element->pq_element);
+        queue->free_priority(combined_element->pq_element_priority);
+        if (keep_capacity) {
+            combined_element->pq_element = queue->spare_combined_elements;
+            queue->spare_combined_elements = combined_element;
+        } else {
+            pqDeallocate(queue, combined_element);
+        }
     }
 
-
-    PriorityQueueResult insert_result = pqInsert(queue, element, new_priority);
-    if (insert_result == PQ_OUT_OF_MEMORY) {
-        return PQ_OUT_OF_MEMORY;
+    if (queue->filter != NULL) {
+        for (int i = 0; i < queue->filter->counters_count; i++) {
+            queue->filter->counters[i] = 0;
+        }
     }
 
-    pqRemoveByNode(queue, target_node);
+    if (keep_capacity) {
+        listClearKeepCapacity(queue->elements_list);
+    } else {
+        listClear(queue->elements_list);
+        destroySpareCombinedElements(queue);
+    }
     queue->iterator = NULL;
-    return PQ_SUCCESS;
 }
 
-PriorityQueueResult pqRemove(PriorityQueue queue) {
-    if (queue == NULL) {
-        return PQ_NULL_ARGUMENT;
+/* Closes a spilled run and frees it, along with its read-ahead buffer and its head entry if there is one */
+static void destroySpilledRun(PriorityQueue queue, SpilledRun run) {
+    if (run->head != NULL) {
+        destroyCombinedElement(queue, run->head);
+    }
+    if (run->file != NULL) {
+        fclose(run->file);
+    }
+    if (run->read_ahead_buffer != NULL) {
+        pqDeallocate(queue, run->read_ahead_buffer);
     }
+    pqDeallocate(queue, run);
+}
 
-    pqRemoveByNode(queue, listGetFirst(queue->elements_list));
+/* Reads the next entry of a spilled run to its head. The head is set to NULL if the run is exhausted.
+ * Returns false if reading failed (the head is NULL in that case too) */
+static bool readSpilledRunHead(PriorityQueue queue, SpilledRun run) {
+    run->head = NULL;
+    if (run->remaining_size == 0) {
+        return true;
+    }
 
-    return PQ_SUCCESS;
+    CombinedElement combined_element = allocateCombinedElement(queue);
+    if (combined_element == NULL) {
+        return false;
+    }
+
+    combined_element->pq_element = queue->external->read_element(run->file);
+    combined_element->pq_element_priority = queue->external->read_priority(run->file);
+    if (combined_element->pq_element == NULL || combined_element->pq_element_priority == NULL) {
+        destroyCombinedElement(queue, combined_element);
+        return false;
+    }
+
+    run->head = combined_element;
+    run->remaining_size--;
+    return true;
 }
 
-PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element) {
-    if (queue == NULL || element == NULL) {
-        return PQ_NULL_ARGUMENT;
+/* Creates an empty run of the given level to be written, with an open temporary file and a read-ahead buffer
+ * of read_ahead_bytes */
+static PriorityQueueResult createSpilledRun(PriorityQueue queue, int level, SpilledRun *new_run) {
+    SpilledRun run = pqAllocate(queue, sizeof(*run));
+    if (run == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    run->file = NULL;
+    run->read_ahead_buffer = pqAllocate(queue, queue->external->read_ahead_bytes);
+    run->head = NULL;
+    run->remaining_size = 0;
+    run->level = level;
+    if (run->read_ahead_buffer == NULL) {
+        destroySpilledRun(queue, run);
+        return PQ_OUT_OF_MEMORY;
     }
 
-    LinkedNode target_node = getFirstOccurenceByElement(queue, element);
-    if (target_node == NULL) {
-        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    run->file = tmpfile();
+    if (run->file == NULL ||
+        setvbuf(run->file, run->read_ahead_buffer, _IOFBF, queue->external->read_ahead_bytes) != 0) {
+        destroySpilledRun(queue, run);
+        return PQ_ERROR;
     }
 
-    pqRemoveByNode(queue, target_node);
+    *new_run = run;
     return PQ_SUCCESS;
 }
 
-PQElement pqGetFirst(PriorityQueue queue) {
-    if (queue == NULL) {
-        return NULL;
+/* Writes an entry at the end of a run that is being written */
+static bool writeSpilledEntry(PriorityQueue queue, SpilledRun run, CombinedElement combined_element) {
+    if (!queue->external->write_element(combined_element->pq_element, run->file) ||
+        !queue->external->write_priority(combined_element->pq_element_priority, run->file)) {
+        return false;
     }
+    run->remaining_size++;
+    return true;
+}
 
-    LinkedNode first_node = listGetFirst(queue->elements_list);
-    queue->iterator = first_node;
-    if (first_node == NULL) {
-        return NULL;
+/* Ends the writing of a run and reads its first entry back to its head */
+static bool finishSpilledRun(PriorityQueue queue, SpilledRun run) {
+    return fflush(run->file) == 0 && fseek(run->file, 0, SEEK_SET) == 0 && readSpilledRunHead(queue, run);
+}
+
+/* Closes the run at run_index and removes it from the runs (its entries are no longer counted) */
+static void removeSpilledRun(PriorityQueue queue, int run_index) {
+    ExternalStorage external = queue->external;
+    SpilledRun run = external->runs[run_index];
+    external->spilled_size -= run->remaining_size + (run->head != NULL ? 1 : 0);
+    destroySpilledRun(queue, run);
+    for (int i = run_index; i < external->runs_count - 1; i++) {
+        external->runs[i] = external->runs[i + 1];
     }
-    return ((CombinedElement) listGetData(first_node))->pq_element;
+    external->runs_count--;
 }
 
-PQElement pqGetNext(PriorityQueue queue) {
-    if (queue == NULL) {
-        return NULL;
+/* Where a run was before a merge started reading it, so a failed merge can put it back as it was */
+typedef struct {
+    fpos_t position;
+    CombinedElement head;
+    int64_t remaining_size;
+} SpilledRunMark;
+
+/* Puts a run back to its mark, freeing the head that was read after it. Returns false if seeking failed */
+static bool rewindSpilledRun(PriorityQueue queue, SpilledRun run, SpilledRunMark *mark) {
+    if (run->head != NULL && run->head != mark->head) {
+        destroyCombinedElement(queue, run->head);
     }
+    run->head = mark->head;
+    run->remaining_size = mark->remaining_size;
+    return fsetpos(run->file, &mark->position) == 0;
+}
 
-    if (queue->iterator == NULL) {
-        return NULL;
+/* Merges the runs from first_run_index to the newest one into a single run, which takes their place.
+ * On equal priorities the older run is taken first, so the merged run keeps the insertion order tie-breaker.
+ * The merged runs keep their first heads until the merged run is finished, so if writing or reading fails
+ * they are rewound to where they were and PQ_ERROR is returned, without losing any entry (unless a run cannot
+ * even be rewound, in which case the rest of it is dropped, as when removing its head fails to read) */
+static PriorityQueueResult mergeSpilledRuns(PriorityQueue queue, int first_run_index) {
+    ExternalStorage external = queue->external;
+    SpilledRunMark marks[EXTERNAL_MAX_RUNS];
+    int level = 0;
+    for (int i = first_run_index; i < external->runs_count; i++) {
+        SpilledRun run = external->runs[i];
+        if (run->level >= level) {
+            level = run->level + 1;
+        }
+        if (fgetpos(run->file, &marks[i].position) != 0) {
+            return PQ_ERROR;
+        }
+        marks[i].head = run->head;
+        marks[i].remaining_size = run->remaining_size;
     }
 
-    queue->iterator = listGetNext(queue->iterator);
-    if (queue->iterator == NULL) {
-        return NULL;
+    SpilledRun merged_run = NULL;
+    PriorityQueueResult result = createSpilledRun(queue, level, &merged_run);
+    if (result != PQ_SUCCESS) {
+        return result;
+    }
+
+    bool is_merged = true;
+    while (is_merged) {
+        int source = EXTERNAL_SOURCE_NONE;
+        for (int i = first_run_index; i < external->runs_count; i++) {
+            CombinedElement head = external->runs[i]->head;
+            if (head != NULL && (source == EXTERNAL_SOURCE_NONE ||
+                                 queue->compare_priorities(head->pq_element_priority,
+                                                           external->runs[source]->head->pq_element_priority) > 0)) {
+                source = i;
+            }
+        }
+        if (source == EXTERNAL_SOURCE_NONE) {
+            break;
+        }
+
+        SpilledRun run = external->runs[source];
+        is_merged = writeSpilledEntry(queue, merged_run, run->head);
+        if (is_merged) {
+            if (run->head != marks[source].head) {
+                destroyCombinedElement(queue, run->head);
+            }
+            is_merged = readSpilledRunHead(queue, run);
+        }
+    }
+
+    if (!is_merged || !finishSpilledRun(queue, merged_run)) {
+        destroySpilledRun(queue, merged_run);
+        for (int i = external->runs_count - 1; i >= first_run_index; i--) {
+            if (!rewindSpilledRun(queue, external->runs[i], &marks[i])) {
+                removeSpilledRun(queue, i);
+            }
+        }
+        return PQ_ERROR;
+    }
+
+    // The merged run holds the entries the merged runs were counted with, so spilled_size stays the same
+    for (int i = first_run_index; i < external->runs_count; i++) {
+        destroyCombinedElement(queue, marks[i].head);
+    }
+    while (external->runs_count > first_run_index) {
+        removeSpilledRun(queue, external->runs_count - 1);
+    }
+    external->runs[external->runs_count] = merged_run;
+    external->runs_count++;
+    return PQ_SUCCESS;
+}
+
+/* Keeps the amount of runs bounded. Whenever the newest EXTERNAL_MERGE_FAN_IN runs have the same level they are
+ * merged into one run of the next level, so every entry is rewritten once per level. If there are still
+ * EXTERNAL_MAX_RUNS - 1 runs after that, all of them are merged into one */
+static PriorityQueueResult compactSpilledRuns(PriorityQueue queue) {
+    ExternalStorage external = queue->external;
+    while (external->runs_count >= EXTERNAL_MERGE_FAN_IN) {
+        int first_run_index = external->runs_count - EXTERNAL_MERGE_FAN_IN;
+        bool is_same_level = true;
+        for (int i = first_run_index + 1; i < external->runs_count; i++) {
+            is_same_level = is_same_level && external->runs[i]->level == external->runs[first_run_index]->level;
+        }
+        if (!is_same_level) {
+            break;
+        }
+
+        PriorityQueueResult result = mergeSpilledRuns(queue, first_run_index);
+        if (result != PQ_SUCCESS) {
+            return result;
+        }
     }
 
-    return ((CombinedElement) listGetData(queue->iterator))->pq_element;
+    if (external->runs_count >= EXTERNAL_MAX_RUNS - 1) {
+        return mergeSpilledRuns(queue, 0);
+    }
+    return PQ_SUCCESS;
 }
 
-PriorityQueueResult pqClear(PriorityQueue queue) {
-    if (queue == NULL) {
-        return PQ_NULL_ARGUMENT;
+/* Writes all the entries of the elements_list, in order, to a new spilled run, clears the list and merges runs
+ * if there are too many of them. A failed merge leaves the runs as they were and is tried again by the next
+ * spill. If it left EXTERNAL_MAX_RUNS - 1 runs, they are merged before the spill, and the entries are kept in
+ * memory (and PQ_ERROR returned) if that fails again, so there is always room for the new run */
+static PriorityQueueResult spillElementsList(PriorityQueue queue) {
+    ExternalStorage external = queue->external;
+    if (external->runs_count >= EXTERNAL_MAX_RUNS - 1) {
+        PriorityQueueResult merge_result = mergeSpilledRuns(queue, 0);
+        if (merge_result != PQ_SUCCESS) {
+            return merge_result;
+        }
+    }
+
+    SpilledRun run = NULL;
+    PriorityQueueResult result = createSpilledRun(queue, 0, &run);
+    if (result != PQ_SUCCESS) {
+        return result;
     }
 
+    LIST_FOREACH(queue->elements_list, node) {
+        if (!writeSpilledEntry(queue, run, listGetData(node))) {
+            destroySpilledRun(queue, run);
+            return PQ_ERROR;
+        }
+    }
 
-    while (pqGetSize(queue) > 0) {
-        pqRemove(queue);
+    if (!finishSpilledRun(queue, run)) {
+        destroySpilledRun(queue, run);
+        return PQ_ERROR;
     }
 
+    external->runs[external->runs_count] = run;
+    external->runs_count++;
+    external->spilled_size += listGetSize64(queue->elements_list);
+    clearElementsList(queue, true);
+    // The new run is stored either way, since a failed merge leaves the runs as they were
+    compactSpilledRuns(queue);
     return PQ_SUCCESS;
 }
 
+/* Returns the index of the run whose head is the first entry of an external queue, EXTERNAL_SOURCE_MEMORY if the
+ * first entry is the first node of the elements_list, or EXTERNAL_SOURCE_NONE if the queue is empty.
+ * Every run is older than the runs after it and than the elements_list, so on equal priorities
+ * the earliest source is kept to follow the insertion order tie-breaker */
+static int getExternalFirstSource(PriorityQueue queue) {
+    ExternalStorage external = queue->external;
+    int first_source = EXTERNAL_SOURCE_NONE;
+    PQElementPriority first_priority = NULL;
+
+    for (int i = 0; i < external->runs_count; i++) {
+        PQElementPriority current_priority = external->runs[i]->head->pq_element_priority;
+        if (first_priority == NULL || queue->compare_priorities(current_priority, first_priority) > 0) {
+            first_source = i;
+            first_priority = current_priority;
+        }
+    }
+
+    LinkedNode first_node = listGetFirst(queue->elements_list);
+    if (first_node != NULL) {
+        PQElementPriority current_priority = ((CombinedElement) listGetData(first_node))->pq_element_priority;
+        if (first_priority == NULL || queue->compare_priorities(current_priority, first_priority) > 0) {
+            first_source = EXTERNAL_SOURCE_MEMORY;
+        }
+    }
+
+    return first_source;
+}
 
+/* Frees the head of a spilled run and reads the next one, closing the run once it is exhausted.
+ * If reading fails the rest of the run is dropped and PQ_ERROR is returned */
+static PriorityQueueResult removeSpilledRunHead(PriorityQueue queue, int run_index) {
+    ExternalStorage external = queue->external;
+    SpilledRun run = external->runs[run_index];
+
+    destroyCombinedElement(queue, run->head);
+    external->spilled_size--;
+    PriorityQueueResult result = readSpilledRunHead(queue, run) ? PQ_SUCCESS : PQ_ERROR;
+    if (run->head == NULL) {
+        removeSpilledRun(queue, run_index);
+    }
+    return result;
+}
 
+/* Returns the CombinedElement of the first entry in the queue (in memory or in a spilled run),
+ * or NULL if the queue is empty */
+static CombinedElement getFirstCombinedElement(PriorityQueue queue) {
+    if (queue->external != NULL) {
+        int first_source = getExternalFirstSource(queue);
+        if (first_source >= 0) {
+            return queue->external->runs[first_source]->head;
+        }
+    }
 
+    if (isSmall(queue)) {
+        return queue->small_size > 0 ? &queue->small_entries[0] : NULL;
+    }
+
+    LinkedNode first_node = listGetFirst(queue->elements_list);
+    if (first_node == NULL) {
+        return NULL;
+    }
+    return listGetData(first_node);
+}
+
+/* Returns the amount of entries in the queue (unlike pqGetSize64, without recording a trace operation) */
+static int64_t getQueueSize(PriorityQueue queue) {
+    if (queue->external != NULL) {
+        return listGetSize64(queue->elements_list) + queue->external->spilled_size;
+    }
+    if (isSmall(queue)) {
+        return queue->small_size;
+    }
+    return listGetSize64(queue->elements_list);
+}
+
+/* Calls visit for every entry of the queue in order (unlike pqForEach, without recording a trace operation) */
+static void visitAllEntries(PriorityQueue queue, VisitPQEntry visit, void *context) {
+    for (int i = 0; i < queue->small_size; i++) {
+        visit(queue->small_entries[i].pq_element, queue->small_entries[i].pq_element_priority, context);
+    }
+    LIST_FOREACH(queue->elements_list, node) {
+        CombinedElement combined_element = listGetData(node);
+        visit(combined_element->pq_element, combined_element->pq_element_priority, context);
+    }
+}
+
+/* Closes and frees all the spilled runs of an external queue */
+static void clearSpilledRuns(PriorityQueue queue) {
+    ExternalStorage external = queue->external;
+    for (int i = 0; i < external->runs_count; i++) {
+        destroySpilledRun(queue, external->runs[i]);
+    }
+    external->runs_count = 0;
+    external->spilled_size = 0;
+}
+
+/* Appends a CombinedElement to the end of the queue's elements_list. Returns false if an allocation failed */
+static bool appendCombinedElement(PriorityQueue queue, CombinedElement combined_element) {
+    return listInsertEnd(queue->elements_list, combined_element) != NULL;
+}
+
+/* Appends a copy of every entry of queue's elements_list to the end of new_queue's elements_list.
+ * Returns false if an allocation failed (the entries that were already copied stay in new_queue) */
+static bool copyElementsList(PriorityQueue queue, PriorityQueue new_queue) {
+    LIST_FOREACH(queue->elements_list, node) {
+        CombinedElement current_combined_element = listGetData(node);
+        CombinedElement new_combined_element = createCombinedElement(new_queue, current_combined_element->pq_element,
+                                                                     current_combined_element->pq_element_priority);
+        if (new_combined_element == NULL) {
+            return false;
+        }
+
+        if (!appendCombinedElement(new_queue, new_combined_element)) {
+            destroyCombinedElement(new_queue, new_combined_element);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Copies every entry of a small queue to the empty small new_queue, in order.
+ * Returns false if an allocation failed (the entries that were already copied stay in new_queue) */
+static bool copySmallEntries(PriorityQueue queue, PriorityQueue new_queue) {
+    for (int i = 0; i < queue->small_size; i++) {
+        struct CombinedElement_t *entry = &new_queue->small_entries[i];
+        entry->pq_element = queue->copy_element(queue->small_entries[i].pq_element);
+        if (entry->pq_element == NULL) {
+            return false;
+        }
+        entry->pq_element_priority = queue->copy_priority(queue->small_entries[i].pq_element_priority);
+        if (entry->pq_element_priority == NULL) {
+            queue->free_element(entry->pq_element);
+            return false;
+        }
+        new_queue->small_size++;
+    }
+    return true;
+}
+
+/* Type of a task that handles the entries in [begin, end) of a parallel operation */
+typedef void (*ParallelTask)(int64_t begin, int64_t end, void *context);
+
+typedef struct {
+    ParallelTask task;
+    int64_t begin;
+    int64_t end;
+    void *context;
+} ParallelSlice;
+
+/* The thread function of runInParallel */
+static void *runParallelSlice(void *slice) {
+    ParallelSlice *parallel_slice = slice;
+    parallel_slice->task(parallel_slice->begin, parallel_slice->end, parallel_slice->context);
+    return NULL;
+}
+
+/* Returns the amount of threads worth using for count entries, at most threads_count. Every thread gets at least
+ * PARALLEL_MIN_ENTRIES_PER_THREAD entries, since starting a thread costs more than handling fewer entries */
+static int getParallelThreadsCount(int64_t count, int threads_count) {
+    int64_t worthy_threads_count = count / PARALLEL_MIN_ENTRIES_PER_THREAD;
+    if (worthy_threads_count < threads_count) {
+        return worthy_threads_count > 1 ? (int) worthy_threads_count : 1;
+    }
+    return threads_count;
+}
+
+/* Splits the range [0, count) into contiguous slices, as many as getParallelThreadsCount allows, and runs task on
+ * each one in its own thread. The calling thread runs the first slice, and any slice that could not get a thread.
+ * Returns after all the slices are done */
+static void runInParallel(PriorityQueue queue, int64_t count, int threads_count, ParallelTask task, void *context) {
+    threads_count = getParallelThreadsCount(count, threads_count);
+    if (threads_count <= 1) {
+        task(0, count, context);
+        return;
+    }
+
+    ParallelSlice *slices = queue->allocate(threads_count * sizeof(*slices), queue->allocator_context);
+    pthread_t *threads = queue->allocate(threads_count * sizeof(*threads), queue->allocator_context);
+    bool *is_thread_running = queue->allocate(threads_count * sizeof(*is_thread_running), queue->allocator_context);
+    if (slices == NULL || threads == NULL || is_thread_running == NULL) {
+        task(0, count, context);
+        threads_count = 0;
+    }
+
+    for (int i = 0; i < threads_count; i++) {
+        slices[i].task = task;
+        slices[i].begin = count * i / threads_count;
+        slices[i].end = count * (i + 1) / threads_count;
+        slices[i].context = context;
+        is_thread_running[i] = i > 0 && pthread_create(&threads[i], NULL, runParallelSlice, &slices[i]) == 0;
+    }
+
+    for (int i = 0; i < threads_count; i++) {
+        if (!is_thread_running[i]) {
+            runParallelSlice(&slices[i]);
+        }
+    }
+    for (int i = 0; i < threads_count; i++) {
+        if (is_thread_running[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    if (slices != NULL) {
+        queue->deallocate(slices, queue->allocator_context);
+    }
+    if (threads != NULL) {
+        queue->deallocate(threads, queue->allocator_context);
+    }
+    if (is_thread_running != NULL) {
+        queue->deallocate(is_thread_running, queue->allocator_context);
+    }
+}
+
+/* Returns a newly allocated array (allocated with the queue's allocator) of the queue's CombinedElements in order,
+ * or NULL if the allocation failed or the queue is empty */
+static CombinedElement *getCombinedElementsArray(PriorityQueue queue) {
+    int64_t size = listGetSize64(queue->elements_list);
+    if (size == 0) {
+        return NULL;
+    }
+
+    CombinedElement *combined_elements = queue->allocate(size * sizeof(*combined_elements), queue->allocator_context);
+    if (combined_elements == NULL) {
+        return NULL;
+    }
+
+    int64_t i = 0;
+    LIST_FOREACH(queue->elements_list, node) {
+        combined_elements[i] = listGetData(node);
+        i++;
+    }
+    return combined_elements;
+}
+
+typedef struct {
+    PriorityQueue queue;
+    CombinedElement *sources;
+    struct CombinedElement_t *copies;
+} ParallelCopy;
+
+/* The ParallelTask of pqCopyParallel, copies the elements and priorities of the sources in [begin, end) */
+static void copyCombinedElementsSlice(int64_t begin, int64_t end, void *context) {
+    ParallelCopy *parallel_copy = context;
+    for (int64_t i = begin; i < end; i++) {
+        parallel_copy->copies[i].pq_element = parallel_copy->queue->copy_element(parallel_copy->sources[i]->pq_element);
+        parallel_copy->copies[i].pq_element_priority =
+                parallel_copy->queue->copy_priority(parallel_copy->sources[i]->pq_element_priority);
+    }
+}
+
+typedef struct {
+    CombinedElement *combined_elements;
+    VisitPQEntry visit;
+    void *context;
+} ParallelForEach;
+
+/* The ParallelTask of pqForEachParallel, visits the entries in [begin, end) */
+static void visitCombinedElementsSlice(int64_t begin, int64_t end, void *context) {
+    ParallelForEach *parallel_for_each = context;
+    for (int64_t i = begin; i < end; i++) {
+        CombinedElement combined_element = parallel_for_each->combined_elements[i];
+        parallel_for_each->visit(combined_element->pq_element, combined_element->pq_element_priority,
+                                 parallel_for_each->context);
+    }
+}
+
+
+/* Gives new_queue a filter with the same hash function and size as queue's filter, if queue has one */
+static bool copyFilter(PriorityQueue queue, PriorityQueue new_queue) {
+    if (queue->filter == NULL) {
+        return true;
+    }
+    return pqEnableMembershipFilter(new_queue, queue->filter->hash_element, queue->filter->counters_count) ==
+           PQ_SUCCESS;
+}
+
+/* Creates an empty queue. A small queue is allocated together with its small_entries, and any other queue
+ * gets its elements_list right away */
+static PriorityQueue createQueue(CopyPQElement copy_element, FreePQElement free_element,
+                                 EqualPQElements equal_elements, CopyPQElementPriority copy_priority,
+                                 FreePQElementPriority free_priority, ComparePQElementPriorities compare_priorities,
+                                 AllocateFunction allocate, DeallocateFunction deallocate, void *allocator_context,
+                                 bool is_small) {
+    if (copy_element == NULL || free_element == NULL || equal_elements == NULL || copy_priority == NULL ||
+        free_priority == NULL || compare_priorities == NULL || allocate == NULL || deallocate == NULL) {
+        return NULL;
+    }
+
+    size_t small_entries_size = is_small ? SMALL_QUEUE_CAPACITY * sizeof(struct CombinedElement_t) : 0;
+    PriorityQueue queue = allocate(sizeof(struct PriorityQueue_t) + small_entries_size, allocator_context);
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    queue->elements_list = NULL;
+    if (!is_small) {
+        queue->elements_list = listCreateWithAllocator(allocate, deallocate, allocator_context);
+        if (queue->elements_list == NULL) {
+            deallocate(queue, allocator_context);
+            return NULL;
+        }
+    }
+
+    queue->iterator = NULL;
+    queue->has_small_entries = is_small;
+    queue->small_size = 0;
+    queue->small_iterator = SMALL_INDEX_NONE;
+    queue->capacity = UNBOUNDED_CAPACITY;
+    queue->external = NULL;
+    queue->spare_combined_elements = NULL;
+    queue->filter = NULL;
+    queue->trace_file = NULL;
+    queue->trace_write_element = NULL;
+    queue->trace_write_priority = NULL;
+    queue->copy_element = copy_element;
+    queue->free_element = free_element;
+    queue->equal_elements = equal_elements;
+    queue->copy_priority = copy_priority;
+    queue->free_priority = free_priority;
+    queue->compare_priorities = compare_priorities;
+    queue->allocate = allocate;
+    queue->deallocate = deallocate;
+    queue->allocator_context = allocator_context;
+
+    return queue;
+}
+
+PriorityQueue pqCreate(CopyPQElement copy_element,
+                       FreePQElement free_element,
+                       EqualPQElements equal_elements,
+                       CopyPQElementPriority copy_priority,
+                       FreePQElementPriority free_priority,
+                       ComparePQElementPriorities compare_priorities) {
+    return pqCreateWithAllocator(copy_element, free_element, equal_elements, copy_priority, free_priority,
+                                 compare_priorities, defaultAllocate, defaultDeallocate, NULL);
+}
+
+PriorityQueue pqCreateWithAllocator(CopyPQElement copy_element,
+                                    FreePQElement free_element,
+                                    EqualPQElements equal_elements,
+                                    CopyPQElementPriority copy_priority,
+                                    FreePQElementPriority free_priority,
+                                    ComparePQElementPriorities compare_priorities,
+                                    AllocateFunction allocate,
+                                    DeallocateFunction deallocate,
+                                    void *allocator_context) {
+    return createQueue(copy_element, free_element, equal_elements, copy_priority, free_priority,
+                       compare_priorities, allocate, deallocate, allocator_context, true);
+}
+
+PriorityQueue pqCreateBounded(int capacity,
+                              CopyPQElement copy_element,
+                              FreePQElement free_element,
+                              EqualPQElements equal_elements,
+                              CopyPQElementPriority copy_priority,
+                              FreePQElementPriority free_priority,
+                              ComparePQElementPriorities compare_priorities) {
+    if (capacity <= 0) {
+        return NULL;
+    }
+
+    PriorityQueue queue = createQueue(copy_element, free_element, equal_elements, copy_priority, free_priority,
+                                      compare_priorities, defaultAllocate, defaultDeallocate, NULL, false);
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    queue->capacity = capacity;
+    return queue;
+}
+
+PriorityQueue pqCreateExternal(int memory_budget,
+                               CopyPQElement copy_element,
+                               FreePQElement free_element,
+                               EqualPQElements equal_elements,
+                               CopyPQElementPriority copy_priority,
+                               FreePQElementPriority free_priority,
+                               ComparePQElementPriorities compare_priorities,
+                               WritePQElement write_element,
+                               ReadPQElement read_element,
+                               WritePQElementPriority write_priority,
+                               ReadPQElementPriority read_priority) {
+    if (memory_budget <= 0 || write_element == NULL || read_element == NULL || write_priority == NULL ||
+        read_priority == NULL) {
+        return NULL;
+    }
+
+    PriorityQueue queue = createQueue(copy_element, free_element, equal_elements, copy_priority, free_priority,
+                                      compare_priorities, defaultAllocate, defaultDeallocate, NULL, false);
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    ExternalStorage external = pqAllocate(queue, sizeof(*external));
+    if (external == NULL) {
+        pqDestroy(queue);
+        return NULL;
+    }
+
+    external->memory_budget = memory_budget;
+    external->list_budget = memory_budget - memory_budget / 4;
+    external->read_ahead_bytes = (size_t) (memory_budget / 4) * EXTERNAL_BYTES_PER_ENTRY / EXTERNAL_MAX_RUNS;
+    if (external->read_ahead_bytes < EXTERNAL_MIN_READ_AHEAD_BYTES) {
+        external->read_ahead_bytes = EXTERNAL_MIN_READ_AHEAD_BYTES;
+    }
+    if (external->read_ahead_bytes > EXTERNAL_MAX_READ_AHEAD_BYTES) {
+        external->read_ahead_bytes = EXTERNAL_MAX_READ_AHEAD_BYTES;
+    }
+    external->runs = pqAllocate(queue, EXTERNAL_MAX_RUNS * sizeof(*external->runs));
+    external->runs_count = 0;
+    external->spilled_size = 0;
+    external->write_element = write_element;
+    external->read_element = read_element;
+    external->write_priority = write_priority;
+    external->read_priority = read_priority;
+    queue->external = external;
+    if (external->runs == NULL) {
+        pqDestroy(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+void pqDestroy(PriorityQueue queue) {
+	if (queue == NULL) {
+        return;
+    }
+    queue->trace_file = NULL;
+    pqClear(queue);
+    if (queue->external != NULL) {
+        if (queue->external->runs != NULL) {
+            pqDeallocate(queue, queue->external->runs);
+        }
+        pqDeallocate(queue, queue->external);
+    }
+    destroyFilter(queue);
+    listDestroy(queue->elements_list);
+    queue->deallocate(queue, queue->allocator_context);
+}
+
+PriorityQueue pqCopy(PriorityQueue queue) {
+    if (queue == NULL || queue->external != NULL) {
+        return NULL;
+    }
+
+    PriorityQueue new_queue = createQueue(queue->copy_element, queue->free_element, queue->equal_elements,
+                                          queue->copy_priority, queue->free_priority, queue->compare_priorities,
+                                          queue->allocate, queue->deallocate, queue->allocator_context,
+                                          isSmall(queue));
+    if (new_queue == NULL || !copySmallEntries(queue, new_queue) || !copyElementsList(queue, new_queue) ||
+        !copyFilter(queue, new_queue)) {
+        pqDestroy(new_queue);
+        return NULL;
+    }
+
+    new_queue->capacity = queue->capacity;
+
+    new_queue->iterator = NULL;
+    queue->iterator = NULL;
+    queue->small_iterator = SMALL_INDEX_NONE;
+    return new_queue;
+}
+
+PriorityQueue pqCopyParallel(PriorityQueue queue, int threads_count) {
+    if (queue == NULL || queue->external != NULL || threads_count <= 0) {
+        return NULL;
+    }
+    if (getParallelThreadsCount(getQueueSize(queue), threads_count) <= 1) {
+        // The queue has too few entries to be worth splitting between threads
+        return pqCopy(queue);
+    }
+
+    PriorityQueue new_queue = createQueue(queue->copy_element, queue->free_element, queue->equal_elements,
+                                          queue->copy_priority, queue->free_priority, queue->compare_priorities,
+                                          queue->allocate, queue->deallocate, queue->allocator_context, false);
+    if (new_queue == NULL) {
+        return NULL;
+    }
+    new_queue->capacity = queue->capacity;
+    queue->iterator = NULL;
+
+    int64_t size = listGetSize64(queue->elements_list);
+    ParallelCopy parallel_copy;
+    parallel_copy.queue = queue;
+    parallel_copy.sources = getCombinedElementsArray(queue);
+    parallel_copy.copies = queue->allocate(size * sizeof(*parallel_copy.copies), queue->allocator_context);
+    bool is_copied = parallel_copy.sources != NULL && parallel_copy.copies != NULL;
+    if (is_copied) {
+        runInParallel(queue, size, threads_count, copyCombinedElementsSlice, &parallel_copy);
+    }
+
+    // Stitch the copies to the end of the new queue in order
+    int64_t stitched_count = 0;
+    while (is_copied && stitched_count < size) {
+        struct CombinedElement_t *copy = &parallel_copy.copies[stitched_count];
+        CombinedElement combined_element = NULL;
+        if (copy->pq_element != NULL && copy->pq_element_priority != NULL) {
+            combined_element = allocateCombinedElement(new_queue);
+        }
+        if (combined_element == NULL) {
+            is_copied = false;
+            break;
+        }
+
+        *combined_element = *copy;
+        if (!appendCombinedElement(new_queue, combined_element)) {
+            pqDeallocate(new_queue, combined_element);
+            is_copied = false;
+            break;
+        }
+        stitched_count++;
+    }
+
+    if (parallel_copy.sources != NULL && parallel_copy.copies != NULL) {
+        // After a failure, the copies that were not stitched to the new queue are freed here. A copy function
+        // that failed left NULL in its half, which is not given to the free functions
+        for (int64_t i = stitched_count; i < size; i++) {
+            if (parallel_copy.copies[i].pq_element != NULL) {
+                queue->free_element(parallel_copy.copies[i].pq_element);
+            }
+            if (parallel_copy.copies[i].pq_element_priority != NULL) {
+                queue->free_priority(parallel_copy.copies[i].pq_element_priority);
+            }
+        }
+    }
+    if (parallel_copy.sources != NULL) {
+        queue->deallocate(parallel_copy.sources, queue->allocator_context);
+    }
+    if (parallel_copy.copies != NULL) {
+        queue->deallocate(parallel_copy.copies, queue->allocator_context);
+    }
+    if (!is_copied || !copyFilter(queue, new_queue)) {
+        pqDestroy(new_queue);
+        return NULL;
+    }
+    return new_queue;
+}
+
+PriorityQueueResult pqEnableMembershipFilter(PriorityQueue queue, HashPQElement hash_element, int counters_count) {
+    if (queue == NULL || hash_element == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->external != NULL || counters_count <= 0) {
+        return PQ_ERROR;
+    }
+
+    MembershipFilter filter = queue->allocate(sizeof(*filter), queue->allocator_context);
+    unsigned char *counters = queue->allocate(counters_count * sizeof(*counters), queue->allocator_context);
+    if (filter == NULL || counters == NULL) {
+        if (filter != NULL) {
+            queue->deallocate(filter, queue->allocator_context);
+        }
+        if (counters != NULL) {
+            queue->deallocate(counters, queue->allocator_context);
+        }
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    filter->hash_element = hash_element;
+    filter->counters = counters;
+    filter->counters_count = counters_count;
+    filter->queries = 0;
+    filter->definite_misses = 0;
+    filter->false_positives = 0;
+    for (int i = 0; i < counters_count; i++) {
+        counters[i] = 0;
+    }
+
+    destroyFilter(queue);
+    queue->filter = filter;
+    for (int i = 0; i < queue->small_size; i++) {
+        updateFilter(queue, queue->small_entries[i].pq_element, true);
+    }
+    LIST_FOREACH(queue->elements_list, node) {
+        updateFilter(queue, ((CombinedElement) listGetData(node))->pq_element, true);
+    }
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqGetFilterStats(PriorityQueue queue, PQFilterStats *stats) {
+    if (queue == NULL || stats == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->filter == NULL) {
+        return PQ_ERROR;
+    }
+
+    stats->queries = queue->filter->queries;
+    stats->definite_misses = queue->filter->definite_misses;
+    stats->false_positives = queue->filter->false_positives;
+    long negative_queries = stats->definite_misses + stats->false_positives;
+    stats->false_positive_rate = negative_queries == 0 ? 0 : (double) stats->false_positives / negative_queries;
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqStartTrace(PriorityQueue queue, FILE *trace_file, uint32_t serializer_id,
+                                 WritePQElement write_element, WritePQElementPriority write_priority) {
+    if (queue == NULL || trace_file == NULL || write_element == NULL || write_priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (!writeTraceHeader(trace_file, serializer_id)) {
+        return PQ_ERROR;
+    }
+
+    queue->trace_file = trace_file;
+    queue->trace_write_element = write_element;
+    queue->trace_write_priority = write_priority;
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqStopTrace(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->trace_file == NULL) {
+        return PQ_ERROR;
+    }
+
+    FILE *trace_file = queue->trace_file;
+    queue->trace_file = NULL;
+    return fflush(trace_file) == 0 ? PQ_SUCCESS : PQ_ERROR;
+}
+
+int pqGetSize(PriorityQueue queue) {
+    int64_t size = pqGetSize64(queue);
+    return size < INT_MAX ? (int) size : INT_MAX;
+}
+
+int64_t pqGetSize64(PriorityQueue queue) {
+    if (queue == NULL) {
+        return LIST_NULL_NO_SIZE;
+    }
+    traceOperation(queue, PQ_TRACE_GET_SIZE, NULL, NULL, NULL);
+    return getQueueSize(queue);
+}
+
+bool pqContains(PriorityQueue queue, PQElement element) {
+    bool is_contained = false;
+    pqLookup(queue, element, &is_contained);
+    return is_contained;
+}
+
+PriorityQueueResult pqLookup(PriorityQueue queue, PQElement element, bool *is_contained) {
+    if (queue == NULL || element == NULL || is_contained == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_CONTAINS, element, NULL, NULL);
+    if (queue->external != NULL) {
+        return PQ_ERROR;
+    }
+
+    if (isSmall(queue)) {
+        *is_contained = getSmallEntryIndex(queue, element, NULL) != SMALL_INDEX_NONE;
+        return PQ_SUCCESS;
+    }
+
+    *is_contained = getFirstOccurenceByElement(queue, element) != NULL;
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    if (queue == NULL || element == NULL || priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_INSERT, element, priority, NULL);
+
+    bool is_full = queue->capacity != UNBOUNDED_CAPACITY && getQueueSize(queue) >= queue->capacity;
+    if (is_full) {
+        CombinedElement worst_combined_element = listGetData(listGetLast(queue->elements_list));
+        // An equal priority would be placed after the current worst entry, so it would be the one evicted
+        if (queue->compare_priorities(priority, worst_combined_element->pq_element_priority) <= 0) {
+            return PQ_ELEMENT_REJECTED;
+        }
+    }
+
+    if (queue->external != NULL && listGetSize64(queue->elements_list) >= queue->external->list_budget) {
+        PriorityQueueResult spill_result = spillElementsList(queue);
+        if (spill_result != PQ_SUCCESS) {
+            return spill_result;
+        }
+    }
+
+    if (isSmall(queue)) {
+        if (queue->small_size < SMALL_QUEUE_CAPACITY) {
+            return insertSmallEntry(queue, element, priority);
+        }
+        if (!leaveSmallMode(queue)) {
+            return PQ_OUT_OF_MEMORY;
+        }
+    }
+
+    PriorityQueueResult insert_result = insertWithoutEviction(queue, element, priority);
+    if (insert_result != PQ_SUCCESS) {
+        return insert_result;
+    }
+
+    if (is_full) {
+        pqRemoveByNode(queue, listGetLast(queue->elements_list));
+    }
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
+                                     PQElementPriority old_priority, PQElementPriority new_priority) {
+    if (queue == NULL || element == NULL || old_priority == NULL || new_priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_CHANGE_PRIORITY, element, old_priority, new_priority);
+    if (queue->external != NULL) {
+        return PQ_ERROR;
+    }
+
+    if (isSmall(queue)) {
+        return changeSmallEntryPriority(queue, element, old_priority, new_priority);
+    }
+
+    LinkedNode target_node = getFirstOccurenceByElementAndPriority(queue, element, old_priority);
+    if (target_node == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    PQElementPriority new_priority_copy = queue->copy_priority(new_priority);
+    if (new_priority_copy == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    CombinedElement combined_element = listGetData(target_node);
+    queue->free_priority(combined_element->pq_element_priority);
+    combined_element->pq_element_priority = new_priority_copy;
+
+    // The node is still in the list with its new priority, so it is skipped while looking for its new place
+    LinkedNode previous_biggest_node = getPreviousBiggestNode(queue, new_priority_copy, target_node);
+    if (previous_biggest_node == NULL) {
+        listMoveToStart(queue->elements_list, target_node);
+    } else {
+        listMoveAfter(queue->elements_list, target_node, previous_biggest_node);
+    }
+
+    queue->iterator = NULL;
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqRemove(PriorityQueue queue) {
+    return pqRemoveFirst(queue);
+}
+
+PriorityQueueResult pqRemoveFirst(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_REMOVE_FIRST, NULL, NULL, NULL);
+
+    if (queue->external != NULL) {
+        int first_source = getExternalFirstSource(queue);
+        if (first_source >= 0) {
+            queue->iterator = NULL;
+            return removeSpilledRunHead(queue, first_source);
+        }
+    }
+
+    if (isSmall(queue)) {
+        if (queue->small_size > 0) {
+            removeSmallEntry(queue, 0);
+        }
+        return PQ_SUCCESS;
+    }
+
+    pqRemoveByNode(queue, listGetFirst(queue->elements_list));
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqRemoveLast(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_REMOVE_LAST, NULL, NULL, NULL);
+    if (queue->external != NULL) {
+        return PQ_ERROR;
+    }
+
+    if (isSmall(queue)) {
+        if (queue->small_size > 0) {
+            removeSmallEntry(queue, queue->small_size - 1);
+        }
+        return PQ_SUCCESS;
+    }
+
+    pqRemoveByNode(queue, listGetLast(queue->elements_list));
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element) {
+    if (queue == NULL || element == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_REMOVE_ELEMENT, element, NULL, NULL);
+    if (queue->external != NULL) {
+        return PQ_ERROR;
+    }
+
+    if (isSmall(queue)) {
+        int index = getSmallEntryIndex(queue, element, NULL);
+        if (index == SMALL_INDEX_NONE) {
+            return PQ_ELEMENT_DOES_NOT_EXISTS;
+        }
+        removeSmallEntry(queue, index);
+        return PQ_SUCCESS;
+    }
+
+    LinkedNode target_node = getFirstOccurenceByElement(queue, element);
+    if (target_node == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    pqRemoveByNode(queue, target_node);
+    return PQ_SUCCESS;
+}
+
+int pqCount(PriorityQueue queue, PQElement element) {
+    int64_t count = pqCount64(queue, element);
+    return count < INT_MAX ? (int) count : INT_MAX;
+}
+
+int64_t pqCount64(PriorityQueue queue, PQElement element) {
+    if (queue == NULL || element == NULL) {
+        return LIST_NULL_NO_SIZE;
+    }
+    traceOperation(queue, PQ_TRACE_COUNT, element, NULL, NULL);
+    if (queue->external != NULL) {
+        return LIST_NULL_NO_SIZE;
+    }
+
+    if (!filterMayContain(queue, element, true)) {
+        return 0;
+    }
+
+    int64_t count = 0;
+    for (int i = 0; i < queue->small_size; i++) {
+        if (queue->equal_elements(queue->small_entries[i].pq_element, element)) {
+            count++;
+        }
+    }
+    LIST_FOREACH(queue->elements_list, node) {
+        if (queue->equal_elements(((CombinedElement) listGetData(node))->pq_element, element)) {
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        countFilterFalsePositive(queue);
+    }
+    return count;
+}
+
+int pqRemoveAll(PriorityQueue queue, PQElement element) {
+    int64_t removed_count = pqRemoveAll64(queue, element);
+    return removed_count < INT_MAX ? (int) removed_count : INT_MAX;
+}
+
+int64_t pqRemoveAll64(PriorityQueue queue, PQElement element) {
+    if (queue == NULL || element == NULL) {
+        return LIST_NULL_NO_SIZE;
+    }
+    traceOperation(queue, PQ_TRACE_REMOVE_ALL, element, NULL, NULL);
+    if (queue->external != NULL) {
+        return LIST_NULL_NO_SIZE;
+    }
+
+    if (!filterMayContain(queue, element, true)) {
+        return 0;
+    }
+
+    int64_t removed_count = 0;
+    // Removing from the end of small_entries does not move the entries that are still to be checked
+    for (int i = queue->small_size - 1; i >= 0; i--) {
+        if (queue->equal_elements(queue->small_entries[i].pq_element, element)) {
+            removeSmallEntry(queue, i);
+            removed_count++;
+        }
+    }
+    LinkedNode current_node = listGetFirst(queue->elements_list);
+    while (current_node != NULL) {
+        LinkedNode next_node = listGetNext(current_node);
+        if (queue->equal_elements(((CombinedElement) listGetData(current_node))->pq_element, element)) {
+            pqRemoveByNode(queue, current_node);
+            removed_count++;
+        }
+        current_node = next_node;
+    }
+
+    if (removed_count == 0) {
+        countFilterFalsePositive(queue);
+    }
+    queue->iterator = NULL;
+    return removed_count;
+}
+
+PriorityQueueResult pqForEach(PriorityQueue queue, VisitPQEntry visit, void *context) {
+    if (queue == NULL || visit == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_FOR_EACH, NULL, NULL, NULL);
+    if (queue->external != NULL) {
+        return PQ_ERROR;
+    }
+
+    visitAllEntries(queue, visit, context);
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqForEachParallel(PriorityQueue queue, VisitPQEntry visit, void *context, int threads_count) {
+    if (queue == NULL || visit == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->external != NULL || threads_count <= 0) {
+        return PQ_ERROR;
+    }
+    if (getParallelThreadsCount(getQueueSize(queue), threads_count) <= 1) {
+        visitAllEntries(queue, visit, context);
+        return PQ_SUCCESS;
+    }
+
+    ParallelForEach parallel_for_each;
+    parallel_for_each.combined_elements = getCombinedElementsArray(queue);
+    parallel_for_each.visit = visit;
+    parallel_for_each.context = context;
+    if (parallel_for_each.combined_elements == NULL) {
+        // The queue is empty or there is no memory for splitting it, so it is visited by this thread alone
+        visitAllEntries(queue, visit, context);
+        return PQ_SUCCESS;
+    }
+
+    runInParallel(queue, listGetSize64(queue->elements_list), threads_count, visitCombinedElementsSlice,
+                  &parallel_for_each);
+    queue->deallocate(parallel_for_each.combined_elements, queue->allocator_context);
+    return PQ_SUCCESS;
+}
+
+PQElement pqGetFirst(PriorityQueue queue) {
+    if (queue == NULL) {
+        return NULL;
+    }
+    traceOperation(queue, PQ_TRACE_GET_FIRST, NULL, NULL, NULL);
+
+    CombinedElement first_combined_element = getFirstCombinedElement(queue);
+    queue->iterator = queue->external != NULL ? NULL : listGetFirst(queue->elements_list);
+    queue->small_iterator = queue->small_size > 0 ? 0 : SMALL_INDEX_NONE;
+    if (first_combined_element == NULL) {
+        return NULL;
+    }
+    return first_combined_element->pq_element;
+}
+
+PriorityQueueResult pqGetFirstEntry(PriorityQueue queue, PQElement *element, PQElementPriority *priority) {
+    if (queue == NULL || element == NULL || priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_GET_FIRST_ENTRY, NULL, NULL, NULL);
+
+    CombinedElement first_combined_element = getFirstCombinedElement(queue);
+    if (first_combined_element == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    *element = first_combined_element->pq_element;
+    *priority = first_combined_element->pq_element_priority;
+    return PQ_SUCCESS;
+}
+
+PQElementPriority pqGetPriority(PriorityQueue queue, PQElement element) {
+    if (queue == NULL || element == NULL) {
+        return NULL;
+    }
+    traceOperation(queue, PQ_TRACE_GET_PRIORITY, element, NULL, NULL);
+    if (queue->external != NULL) {
+        return NULL;
+    }
+
+    if (isSmall(queue)) {
+        int index = getSmallEntryIndex(queue, element, NULL);
+        return index == SMALL_INDEX_NONE ? NULL : queue->small_entries[index].pq_element_priority;
+    }
+
+    LinkedNode target_node = getFirstOccurenceByElement(queue, element);
+    if (target_node == NULL) {
+        return NULL;
+    }
+    return ((CombinedElement) listGetData(target_node))->pq_element_priority;
+}
+
+PQElement pqGetLast(PriorityQueue queue) {
+    if (queue == NULL) {
+        return NULL;
+    }
+    traceOperation(queue, PQ_TRACE_GET_LAST, NULL, NULL, NULL);
+    if (queue->external != NULL) {
+        return NULL;
+    }
+
+    if (isSmall(queue)) {
+        return queue->small_size > 0 ? queue->small_entries[queue->small_size - 1].pq_element : NULL;
+    }
+
+    LinkedNode last_node = listGetLast(queue->elements_list);
+    if (last_node == NULL) {
+        return NULL;
+    }
+    return ((CombinedElement) listGetData(last_node))->pq_element;
+}
+
+PQElement pqGetNext(PriorityQueue queue) {
+    PQElement element = NULL;
+    PQElementPriority priority;
+    if (pqGetNextEntry(queue, &element, &priority) != PQ_SUCCESS) {
+        return NULL;
+    }
+    return element;
+}
+
+PriorityQueueResult pqGetNextEntry(PriorityQueue queue, PQElement *element, PQElementPriority *priority) {
+    if (queue == NULL || element == NULL || priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    traceOperation(queue, PQ_TRACE_GET_NEXT, NULL, NULL, NULL);
+    if (queue->external != NULL) {
+        return PQ_ERROR;
+    }
+
+    if (isSmall(queue)) {
+        if (queue->small_iterator == SMALL_INDEX_NONE || queue->small_iterator + 1 >= queue->small_size) {
+            queue->small_iterator = SMALL_INDEX_NONE;
+            return PQ_ELEMENT_DOES_NOT_EXISTS;
+        }
+        queue->small_iterator++;
+        *element = queue->small_entries[queue->small_iterator].pq_element;
+        *priority = queue->small_entries[queue->small_iterator].pq_element_priority;
+        return PQ_SUCCESS;
+    }
+
+    if (queue->iterator == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    queue->iterator = listGetNext(queue->iterator);
+    if (queue->iterator == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    CombinedElement combined_element = listGetData(queue->iterator);
+    *element = combined_element->pq_element;
+    *priority = combined_element->pq_element_priority;
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqClear(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    traceOperation(queue, PQ_TRACE_CLEAR, NULL, NULL, NULL);
+    clearElementsList(queue, false);
+    if (queue->has_small_entries) {
+        // An empty queue fits in small_entries again, so it is back to a single allocation
+        listDestroy(queue->elements_list);
+        queue->elements_list = NULL;
+    }
+    if (queue->external != NULL) {
+        clearSpilledRuns(queue);
+    }
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqClearKeepCapacity(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    traceOperation(queue, PQ_TRACE_CLEAR_KEEP_CAPACITY, NULL, NULL, NULL);
+    clearElementsList(queue, true);
+    if (queue->external != NULL) {
+        clearSpilledRuns(queue);
+    }
+
+    return PQ_SUCCESS;
+}
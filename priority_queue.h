@@ -2,6 +2,9 @@
 #define PRIORITY_QUEUE_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "allocator.h"
 
 /**
 * Generic Priority Queue Container
@@ -13,10 +16,22 @@
 *
 * The following functions are available:
 *   pqCreate		    - Creates a new empty priority queue
+*   pqCreateWithAllocator - Creates a new empty priority queue that allocates its memory with given functions
+*   pqCreateBounded	    - Creates a new empty priority queue that keeps at most capacity elements
+*   pqCreateExternal	- Creates a new empty priority queue that spills its entries to temporary files
 *   pqDestroy		    - Deletes an existing priority queue and frees all resources
 *   pqCopy		        - Copies an existing priority queue
+*   pqCopyParallel	    - Copies an existing priority queue, running the copy functions on several threads
 *   pqGetSize		    - Returns the size of a given priority queue
+*   pqGetSize64	    - Returns the size of a given priority queue, which may exceed INT_MAX
+*   pqEnableMembershipFilter - Adds a filter that answers lookups of missing elements without a search
+*   pqGetFilterStats	- Returns the statistics of the membership filter
+*   pqStartTrace	    - Starts recording every operation on the priority queue to a trace file
+*   pqStopTrace	    - Stops recording operations on the priority queue
 *   pqContains	        - returns whether or not an element exists inside the priority queue.
+*   pqLookup	        - Same as pqContains, but tells apart lookups that the queue does not support
+*   pqCount	        - Returns the amount of times an element exists inside the priority queue.
+*   pqCount64	        - Same as pqCount, for an amount that may exceed INT_MAX
 *   pqInsert	        - Insert an element with a given priority to the queue.
 *   				        Duplication in the priority queue is allowed.
 *   				        Iterator value is undefined after this operation.
@@ -24,10 +39,23 @@
 *					        Iterator value is undefined after this operation.
 *   pqRemove		    - Removes the highest priority element in the queue
 *                           Iterator value is undefined after this operation.
+*   pqRemoveAll		    - Removes all the occurrences of an element from the queue
+*                           Iterator value is undefined after this operation.
+*   pqRemoveAll64	    - Same as pqRemoveAll, for an amount that may exceed INT_MAX
+*   pqRemoveFirst	    - Same as pqRemove
+*   pqRemoveLast	    - Removes the lowest priority element in the queue
+*                           Iterator value is undefined after this operation.
 *   pqGetFirst	        - Sets the internal iterator to the first element in the priority queue and returns it
 *   pqGetNext		    - Advances the internal iterator to the next key and returns it.
+*   pqGetFirstEntry	    - Returns both the first element and its priority
+*   pqGetNextEntry	    - Advances the internal iterator and returns both the element and its priority
+*   pqGetPriority	    - Returns the priority of an element in the priority queue
+*   pqGetLast		    - Returns the last (lowest priority) element in the priority queue
 *	pqClear		        - Clears the contents of the priority queue. Frees all the elements of
 *	 				        the queue using the free function.
+*	pqClearKeepCapacity - Same as pqClear, but keeps the internal storage for reuse
+*	pqForEach	        - Calls a function for every element and priority in the queue, in order
+*	pqForEachParallel   - Calls a function for every element and priority in the queue, on several threads
 * 	PQ_FOREACH	        - A macro for iterating over the priority queue's elements.
 */
 
@@ -41,7 +69,8 @@ typedef enum PriorityQueueResult_t {
     PQ_NULL_ARGUMENT,
     PQ_ELEMENT_DOES_NOT_EXISTS,
     PQ_ITEM_DOES_NOT_EXIST,
-    PQ_ERROR
+    PQ_ERROR,
+    PQ_ELEMENT_REJECTED
 } PriorityQueueResult;
 
 
@@ -64,6 +93,85 @@ typedef void(*FreePQElement)(PQElement);
 typedef void(*FreePQElementPriority)(PQElementPriority);
 
 
+/**
+* Types of functions for writing a data element / priority to a file and reading it back.
+* The write functions should return true on success and false otherwise.
+* The read functions should return a newly allocated element / priority (which the queue frees with the
+* free functions), or NULL if reading failed.
+*/
+typedef bool(*WritePQElement)(PQElement, FILE *);
+
+typedef PQElement(*ReadPQElement)(FILE *);
+
+typedef bool(*WritePQElementPriority)(PQElementPriority, FILE *);
+
+typedef PQElementPriority(*ReadPQElementPriority)(FILE *);
+
+/**
+* Type of function called by pqForEach and pqForEachParallel for every element and its priority.
+* context is the value given to them by the caller.
+*/
+typedef void(*VisitPQEntry)(PQElement, PQElementPriority, void *context);
+
+/**
+* Type of function for hashing a data element, used by the membership filter (see pqEnableMembershipFilter).
+* Elements that are equal by the queue's EqualPQElements function must have the same hash.
+*/
+typedef uint64_t(*HashPQElement)(PQElement);
+
+/** Statistics of the membership filter of a priority queue (see pqGetFilterStats) */
+typedef struct PQFilterStats_t {
+    /** The amount of element lookups that were checked by the filter */
+    long queries;
+    /** The amount of lookups that the filter answered without searching the queue */
+    long definite_misses;
+    /** The amount of lookups that passed the filter but did not find the element */
+    long false_positives;
+    /** false_positives out of all the lookups of elements that were not in the queue (0 if there were none) */
+    double false_positive_rate;
+} PQFilterStats;
+
+/**
+* A trace file (see pqStartTrace) starts with a header: the 4 bytes of PQ_TRACE_MAGIC, PQ_TRACE_VERSION as a single
+* byte, and the serializer id given to pqStartTrace as 4 bytes, most significant first. A reader should reject
+* a trace whose header does not match the version and the serializer it knows.
+*/
+#define PQ_TRACE_MAGIC "PQTR"
+#define PQ_TRACE_MAGIC_LENGTH 4
+#define PQ_TRACE_VERSION 1
+
+/**
+* The operations recorded in a trace file after its header. Every record is the operation as a single byte,
+* followed by its arguments, each written by the write function of its type:
+* 		PQ_TRACE_INSERT - element, priority
+* 		PQ_TRACE_CHANGE_PRIORITY - element, old priority, new priority
+* 		PQ_TRACE_REMOVE_ELEMENT, PQ_TRACE_REMOVE_ALL, PQ_TRACE_CONTAINS, PQ_TRACE_COUNT,
+* 		PQ_TRACE_GET_PRIORITY - element
+* 		All the other operations have no arguments.
+* PQ_TRACE_CONTAINS records both pqContains and pqLookup, PQ_TRACE_GET_NEXT both pqGetNext and pqGetNextEntry,
+* PQ_TRACE_GET_SIZE both pqGetSize and pqGetSize64, PQ_TRACE_COUNT both pqCount and pqCount64, and
+* PQ_TRACE_REMOVE_ALL both pqRemoveAll and pqRemoveAll64.
+*/
+typedef enum PQTraceOperation_t {
+    PQ_TRACE_INSERT,
+    PQ_TRACE_CHANGE_PRIORITY,
+    PQ_TRACE_REMOVE_FIRST,
+    PQ_TRACE_REMOVE_LAST,
+    PQ_TRACE_REMOVE_ELEMENT,
+    PQ_TRACE_REMOVE_ALL,
+    PQ_TRACE_CONTAINS,
+    PQ_TRACE_COUNT,
+    PQ_TRACE_GET_PRIORITY,
+    PQ_TRACE_GET_FIRST,
+    PQ_TRACE_CLEAR,
+    PQ_TRACE_CLEAR_KEEP_CAPACITY,
+    PQ_TRACE_GET_FIRST_ENTRY,
+    PQ_TRACE_GET_NEXT,
+    PQ_TRACE_GET_LAST,
+    PQ_TRACE_GET_SIZE,
+    PQ_TRACE_FOR_EACH
+} PQTraceOperation;
+
 /**
 * Type of function used by the priority queue to identify equal elements.
 * This function should return:
@@ -85,6 +193,10 @@ typedef int(*ComparePQElementPriorities)(PQElementPriority, PQElementPriority);
 
 /**
 * pqCreate: Allocates a new empty priority queue.
+* The queue starts small: up to 8 entries are kept in an array inside the queue itself, where they are found
+* and placed by a linear scan, so a small queue costs a single allocation (besides the copies of its elements
+* and priorities). The 9th insertion moves the entries to the general list, where the queue stays until pqClear
+* empties it. The array adds two pointers per entry to the queue (128 bytes on 64-bit platforms).
 *
 * @param copy_element - Function pointer to be used for copying data elements into
 *  	the priority queue or when copying the priority queue.
@@ -109,6 +221,94 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
                        FreePQElementPriority free_priority,
                        ComparePQElementPriorities compare_priorities);
 
+/**
+* pqCreateWithAllocator: Allocates a new empty priority queue that takes all of its internal memory
+* (the queue itself, its list and every entry's bookkeeping) from allocate and returns it with deallocate.
+* The elements and priorities themselves are still allocated by the copy functions.
+* A copy of the queue (pqCopy) uses the same allocator.
+*
+* @param allocate - Function pointer to be used for allocating the internal memory of the priority queue.
+* @param deallocate - Function pointer to be used for freeing memory returned by allocate.
+* @param allocator_context - Passed to allocate and deallocate on every call (for example an arena).
+* All the other parameters are the same as in pqCreate.
+* @return
+* 	NULL - if one of the parameters (other than allocator_context) is NULL or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateWithAllocator(CopyPQElement copy_element,
+                                    FreePQElement free_element,
+                                    EqualPQElements equal_elements,
+                                    CopyPQElementPriority copy_priority,
+                                    FreePQElementPriority free_priority,
+                                    ComparePQElementPriorities compare_priorities,
+                                    AllocateFunction allocate,
+                                    DeallocateFunction deallocate,
+                                    void *allocator_context);
+
+/**
+* pqCreateBounded: Allocates a new empty priority queue that holds at most capacity elements.
+* Once the queue is full, pqInsert compares the new priority with the lowest priority in the queue
+* before copying anything: a new element that would not enter the queue is rejected without calling
+* copy_element, otherwise it is inserted and the last element (see pqGetLast) is evicted.
+* The rejection and the eviction take O(1), but finding the place of an accepted element is a walk up from the
+* last entry, which takes O(k) for an element that outranks k entries (O(1) if it outranks all of them), so O(N)
+* in the worst case rather than O(log N). In a stream where most accepted elements only just pass the worst
+* entry, the walk is short.
+*
+* @param capacity - The maximal amount of elements in the priority queue. Must be positive.
+* All the other parameters are the same as in pqCreate.
+* @return
+* 	NULL - if one of the parameters is NULL, capacity is not positive or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateBounded(int capacity,
+                              CopyPQElement copy_element,
+                              FreePQElement free_element,
+                              EqualPQElements equal_elements,
+                              CopyPQElementPriority copy_priority,
+                              FreePQElementPriority free_priority,
+                              ComparePQElementPriorities compare_priorities);
+
+/**
+* pqCreateExternal: Allocates a new empty external-memory priority queue.
+* The memory part of the queue holds three quarters of memory_budget entries. When an insertion finds it full,
+* all of it is written as a sorted run to a temporary file using the write functions. pqGetFirst and pqRemove
+* compare the first entry in memory with the next entry of every run, and each run is read sequentially
+* through a read-ahead buffer using the read functions. The read-ahead buffers share the last quarter of
+* memory_budget, counted as 64 bytes per entry (at least 256 bytes and at most 1MB per run).
+* Whenever 8 runs of the same generation pile up they are merged into one, and if there are still 31 runs
+* all of them are merged, so at most 32 temporary files are open at once. A merge that fails to write or read
+* leaves its runs as they were and is tried again by the next spill. If the runs can be neither merged nor
+* added to, pqInsert returns PQ_ERROR and keeps the entries it would have spilled in memory.
+* The tie-breaker between equal priorities is the insertion order, as in any other queue.
+*
+* Only pqInsert, pqGetFirst, pqGetFirstEntry, pqRemove (pqRemoveFirst), pqGetSize (pqGetSize64), pqClear
+* and pqDestroy are supported. pqLookup and pqGetNextEntry return PQ_ERROR, and so do the other functions that
+* return a PriorityQueueResult. pqCopy, pqGetLast, pqGetPriority and pqGetNext return NULL, and pqContains
+* returns false, which cannot be told apart from a missing element, so pqLookup should be used instead.
+*
+* @param memory_budget - The maximal amount of entries kept in memory. Must be positive.
+* @param write_element - Function pointer to be used for writing data elements to a run file.
+* @param read_element - Function pointer to be used for reading data elements from a run file.
+* @param write_priority - Function pointer to be used for writing priorities to a run file.
+* @param read_priority - Function pointer to be used for reading priorities from a run file.
+* All the other parameters are the same as in pqCreate.
+* @return
+* 	NULL - if one of the parameters is NULL, memory_budget is not positive or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateExternal(int memory_budget,
+                               CopyPQElement copy_element,
+                               FreePQElement free_element,
+                               EqualPQElements equal_elements,
+                               CopyPQElementPriority copy_priority,
+                               FreePQElementPriority free_priority,
+                               ComparePQElementPriorities compare_priorities,
+                               WritePQElement write_element,
+                               ReadPQElement read_element,
+                               WritePQElementPriority write_priority,
+                               ReadPQElementPriority read_priority);
+
 /**
 * pqDestroy: Deallocates an existing priority queue. Clears all elements by using the
 * free functions.
@@ -119,7 +319,7 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
 void pqDestroy(PriorityQueue queue);
 
 /**
-* pqCopy: Creates a copy of target priority queue.
+* pqCopy: Creates a copy of target priority queue. A copy of a bounded queue has the same capacity.
 * Iterator values for both priority queues are undefined after this operation.
 *
 * @param queue - Target priority queue.
@@ -129,15 +329,111 @@ void pqDestroy(PriorityQueue queue);
 */
 PriorityQueue pqCopy(PriorityQueue queue);
 
+/**
+* pqCopyParallel: Creates a copy of target priority queue like pqCopy, but splits the entries of the queue
+* between threads_count threads (POSIX threads), which call the copy functions concurrently. The copies are then
+* put in the new queue in the original order by the calling thread.
+* Every thread gets at least 256 entries, so a queue with fewer than 512 entries (or threads_count 1) is copied
+* by the calling thread alone, as in pqCopy.
+* The copy and free functions of the queue (and its allocator, if it was created with one) must be thread-safe.
+* Iterator values for both priority queues are undefined after this operation.
+*
+* @param queue - Target priority queue.
+* @param threads_count - The maximal amount of threads to use (including the calling thread). Must be positive.
+* @return
+* 	NULL if a NULL was sent, threads_count is not positive, queue is an external-memory queue
+* 	or a memory allocation failed.
+* 	A Priority Queue containing the same elements as queue otherwise.
+*/
+PriorityQueue pqCopyParallel(PriorityQueue queue, int threads_count);
+
 /**
 * pqGetSize: Returns the number of elements in a priority queue
 * @param queue - The priority queue which size is requested
 * @return
 * 	-1 if a NULL pointer was sent.
+* 	INT_MAX if the priority queue has more elements than that (see pqGetSize64).
 * 	Otherwise the number of elements in the priority queue.
 */
 int pqGetSize(PriorityQueue queue);
 
+/**
+* pqGetSize64: Returns the number of elements in a priority queue, which may exceed INT_MAX
+* @param queue - The priority queue which size is requested
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the priority queue.
+*/
+int64_t pqGetSize64(PriorityQueue queue);
+
+/**
+* pqEnableMembershipFilter: Adds a counting Bloom filter of the elements to the priority queue, which is kept up
+* to date on every insertion and removal. Lookups by element (pqContains, pqCount, pqGetPriority, pqChangePriority,
+* pqRemoveElement and pqRemoveAll) check the filter first, and an element that the filter shows is not in the queue
+* is reported as missing in O(1) instead of searching the whole queue.
+* If the queue already has a filter it is replaced. Copies of the queue get a filter too.
+*
+* @param queue - The priority queue to add the filter to.
+* @param hash_element - Function pointer to be used for hashing elements.
+* @param counters_count - The amount of counters (one byte each) in the filter. Must be positive.
+* 		About 10 counters per element give a false positive rate of roughly 2%.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters.
+* 	PQ_ERROR if counters_count is not positive or queue is an external-memory queue.
+* 	PQ_OUT_OF_MEMORY if an allocation failed. The queue is not changed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqEnableMembershipFilter(PriorityQueue queue, HashPQElement hash_element, int counters_count);
+
+/**
+* pqGetFilterStats: Returns the statistics of the membership filter of the priority queue since it was enabled.
+*
+* @param queue - The priority queue of the filter.
+* @param stats - Pointer to where the statistics are returned.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters.
+* 	PQ_ERROR if the queue has no membership filter.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqGetFilterStats(PriorityQueue queue, PQFilterStats *stats);
+
+/**
+* pqStartTrace: Starts appending a record of every call on the priority queue that changes or reads it
+* (see PQTraceOperation) to trace_file, so the same stream of operations can be replayed later (see pq_replay.c).
+* A call is recorded once its arguments are checked not to be NULL, whether it succeeds or not.
+* Calls that create, copy, configure or destroy the queue are not part of its workload and are not traced:
+* pqCopy, pqCopyParallel, pqEnableMembershipFilter, pqGetFilterStats, pqStartTrace, pqStopTrace and pqDestroy.
+* pqForEachParallel is not traced either, since its cost depends on the threads it gets.
+* Copies of the queue are not traced. If writing a record fails, the tracing stops and the queue goes on as usual.
+* If the queue is already traced, the new trace replaces the old one.
+* The header of the trace (see PQ_TRACE_MAGIC) is written before any record, so a reader can tell what wrote it.
+*
+* @param queue - The priority queue to trace.
+* @param trace_file - The file to write the trace to, from its current position. It is not closed by the queue.
+* @param serializer_id - Identifies the format of write_element and write_priority, so a reader can check that
+* 		it reads the arguments in the same format. The meaning of the ids is up to the callers.
+* @param write_element - Function pointer to be used for writing data elements to the trace.
+* @param write_priority - Function pointer to be used for writing priorities to the trace.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters.
+* 	PQ_ERROR if writing the header failed. The queue is not traced (if it was traced before, it stays so).
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqStartTrace(PriorityQueue queue, FILE *trace_file, uint32_t serializer_id,
+                                 WritePQElement write_element, WritePQElementPriority write_priority);
+
+/**
+* pqStopTrace: Stops recording operations on the priority queue and flushes the trace file.
+* Destroying a traced queue stops the trace too.
+*
+* @param queue - The traced priority queue.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as queue.
+* 	PQ_ERROR if the queue is not traced, or flushing the trace file failed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqStopTrace(PriorityQueue queue);
+
 /**
 * pqContains: Checks if an element exists in the priority queue. The element will be
 * considered in the priority queue if one of the elements in the priority queue it determined equal
@@ -147,11 +443,44 @@ int pqGetSize(PriorityQueue queue);
 * @param element - The element to look for. Will be compared using the
 * 		comparison function.
 * @return
-* 	false - if one or more of the inputs is null, or if the key element was not found.
+* 	false - if one or more of the inputs is null, if the key element was not found, or the queue is an
+* 		external-memory queue (see pqLookup).
 * 	true - if the key element was found in the priority queue.
 */
 bool pqContains(PriorityQueue queue, PQElement element);
 
+/**
+* pqLookup: Checks if an element exists in the priority queue, like pqContains, but reports lookups that
+* the queue cannot answer instead of returning false for them.
+*
+* @param queue - The priority queue to search in
+* @param element - The element to look for.
+* @param is_contained - Pointer to where the answer is returned.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters.
+* 	PQ_ERROR if the queue is an external-memory queue. is_contained is not changed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqLookup(PriorityQueue queue, PQElement element, bool *is_contained);
+
+/**
+* pqCount: Returns the amount of elements in the priority queue that are equal to element (using the
+* comparison function used to initialize the priority queue), in one pass over the queue.
+*
+* @param queue - The priority queue to search in
+* @param element - The element to count.
+* @return
+* 	-1 if one or more of the inputs is null, or the queue is an external-memory queue.
+* 	Otherwise the amount of occurrences of element in the priority queue (0 if it was not found), or INT_MAX
+* 	if there are more than that (see pqCount64).
+*/
+int pqCount(PriorityQueue queue, PQElement element);
+
+/**
+* pqCount64: Same as pqCount, for an amount of occurrences that may exceed INT_MAX
+*/
+int64_t pqCount64(PriorityQueue queue, PQElement element);
+
 /**
 *   pqInsert: add a specified element with a specific priority.
 *   Iterator's value is undefined after this operation.
@@ -165,6 +494,9 @@ bool pqContains(PriorityQueue queue, PQElement element);
 * 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
 * 	PQ_OUT_OF_MEMORY if an allocation failed (Meaning the function for copying
 * 	an element failed)
+* 	PQ_ERROR if the queue is an external-memory queue and writing a run to a temporary file failed
+* 	PQ_ELEMENT_REJECTED if the queue is bounded and full, and priority is not higher than the lowest
+* 	priority in the queue (an equal priority would be placed last, so it is rejected too)
 * 	PQ_SUCCESS the paired elements had been inserted successfully
 */
 PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority);
@@ -174,6 +506,8 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 *           If there are multiple same elements with same priority,
 *           only the first element's priority needs to be changed.
 *           Element that its value has changed is considered as reinserted element.
+*           The element itself is not copied again: only new_priority is copied, and the existing entry is
+*           moved to its new place in the queue.
 *			Iterator's value is undefined after this operation
 *
 * @param queue - The priority queue for which the element from.
@@ -183,7 +517,7 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 * @return
 * 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
 * 	PQ_OUT_OF_MEMORY if an allocation failed (Meaning the function for copying
-* 	an element failed)
+* 	the new priority failed)
 * 	PQ_ELEMENT_DOES_NOT_EXISTS if element with old_priority does not exists in the queue.
 * 	PQ_SUCCESS the paired elements had been inserted successfully
 */
@@ -199,10 +533,58 @@ PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
 * @param queue - The priority queue to remove the element from.
 * @return
 * 	PQ_NULL_ARGUMENT if a NULL was sent to the function.
+* 	PQ_ERROR if the queue is an external-memory queue and reading the next entry of a run failed.
+* 	The rest of that run is dropped.
 * 	PQ_SUCCESS the most prioritized element had been removed successfully.
 */
 PriorityQueueResult pqRemove(PriorityQueue queue);
 
+/**
+*   pqRemoveAll: Removes all the elements in the priority queue which have their value equal to element,
+*   in one pass over the queue. The elements and their priorities are deallocated using the free functions
+*   supplied at initialization.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue to remove the elements from.
+* @param element - The element to find and remove from the priority queue.
+* @return
+* 	-1 if one or more of the inputs is null, or the queue is an external-memory queue.
+* 	Otherwise the amount of elements that were removed (0 if element was not found), or INT_MAX if more than
+* 	that were removed (see pqRemoveAll64).
+*/
+int pqRemoveAll(PriorityQueue queue, PQElement element);
+
+/**
+*   pqRemoveAll64: Same as pqRemoveAll, for an amount of removed elements that may exceed INT_MAX
+*/
+int64_t pqRemoveAll64(PriorityQueue queue, PQElement element);
+
+/**
+*   pqRemoveFirst: Same as pqRemove, named for symmetry with pqRemoveLast.
+*   Runs in O(1).
+*
+* @param queue - The priority queue to remove the element from.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent to the function.
+* 	PQ_SUCCESS the most prioritized element had been removed successfully.
+*/
+PriorityQueueResult pqRemoveFirst(PriorityQueue queue);
+
+/**
+*   pqRemoveLast: Removes the lowest priority element from the priority queue.
+*   The tie-breaker is the insertion order mirrored: if there are multiple elements with the same lowest priority,
+*   the last inserted element is removed first. This is the element returned by pqGetLast.
+*   The elements are removed and deallocated using the free functions supplied at initialization.
+*   Runs in O(1).
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue to remove the element from.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent to the function.
+* 	PQ_SUCCESS the least prioritized element had been removed successfully (or the queue was empty).
+*/
+PriorityQueueResult pqRemoveLast(PriorityQueue queue);
+
 /**
 *   pqRemoveElement: Removes the highest priority element from the priority queue which have its value equal to element.
 *   If there are multiple elements with the same highest priority, the first inserted element should be removed first.
@@ -241,22 +623,128 @@ PQElement pqGetFirst(PriorityQueue queue);
 * @param queue - The priority queue for which to advance the iterator
 * @return
 * 	NULL if reached the end of the priority queue, or the iterator is at an invalid state
-* 	or a NULL sent as argument
+* 	or a NULL sent as argument, or the queue is an external-memory queue (see pqGetNextEntry)
 * 	The next element on the priority queue in case of success
 */
 PQElement pqGetNext(PriorityQueue queue);
 
+/**
+*	pqGetNextEntry: Advances the priority queue iterator to the next element, like pqGetNext, and returns
+*	the element together with its priority (owned by the priority queue, as in pqGetFirstEntry).
+*
+* @param queue - The priority queue for which to advance the iterator
+* @param element - Pointer to where the next element is returned.
+* @param priority - Pointer to where the priority of the next element is returned.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters.
+* 	PQ_ERROR if the queue is an external-memory queue, which cannot be iterated.
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if the iterator reached the end of the priority queue or is at an invalid state.
+* 	PQ_SUCCESS otherwise.
+* 	element and priority are only changed on PQ_SUCCESS.
+*/
+PriorityQueueResult pqGetNextEntry(PriorityQueue queue, PQElement *element, PQElementPriority *priority);
+
+/**
+*	pqGetFirstEntry: Returns the first element in the priority queue (the one pqGetFirst returns) together with
+*	its priority. The returned element and priority are owned by the priority queue (they are not copies), and
+*	are valid until the entry is removed or its priority is changed.
+*	Does not change the internal iterator.
+*
+* @param queue - The priority queue to peek at.
+* @param element - Pointer to where the first element is returned.
+* @param priority - Pointer to where the priority of the first element is returned.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters.
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if the priority queue is empty. element and priority are not changed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqGetFirstEntry(PriorityQueue queue, PQElement *element, PQElementPriority *priority);
+
+/**
+*	pqGetPriority: Returns the priority of an element in the priority queue. If the element is in the queue more
+*	than once, the priority of its first occurrence (the highest one) is returned.
+*	The returned priority is owned by the priority queue (it is not a copy), and can be given as old_priority
+*	to pqChangePriority.
+*	Does not change the internal iterator. Not supported by external-memory queues.
+*
+* @param queue - The priority queue to search in.
+* @param element - The element to look for. Will be compared using the comparison function.
+* @return
+* 	NULL if a NULL was sent as one of the parameters, or the element is not in the priority queue.
+* 	The priority of the first occurrence of element otherwise.
+*/
+PQElementPriority pqGetPriority(PriorityQueue queue, PQElement element);
+
+/**
+*	pqGetLast: Returns the last element in the priority queue, meaning the element with the lowest priority.
+*   If there are multiple elements with the same lowest priority, the last inserted one is returned.
+*	Runs in O(1) and does not change the internal iterator.
+*
+* @param queue - The priority queue for which to return the last element.
+* @return
+* 	NULL if a NULL pointer was sent or the priority queue is empty.
+* 	The last key element of the priority queue otherwise
+*/
+PQElement pqGetLast(PriorityQueue queue);
+
 /**
 * pqClear: Removes all elements and priorities from target priority queue.
-* The elements are deallocated using the stored free functions.
+* The elements are deallocated using the stored free functions, in one linear sweep over the queue,
+* and the internal storage of the queue is released in bulk.
 * @param queue
 * 	Target priority queue to remove all element from.
 * @return
-* 	MAP_NULL_ARGUMENT - if a NULL pointer was sent.
-* 	MAP_SUCCESS - Otherwise.
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
 */
 PriorityQueueResult pqClear(PriorityQueue queue);
 
+/**
+* pqClearKeepCapacity: Removes all elements and priorities from target priority queue like pqClear,
+* but keeps the internal storage that held them allocated. Later insertions reuse it instead of allocating,
+* until the queue is cleared with pqClear or destroyed.
+* @param queue
+* 	Target priority queue to remove all element from.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqClearKeepCapacity(PriorityQueue queue);
+
+/**
+* pqForEach: Calls visit for every element in the priority queue together with its priority, in the queue's order.
+* Unlike PQ_FOREACH, it does not use or change the internal iterator.
+* visit must not change the priority queue.
+*
+* @param queue - The priority queue to visit.
+* @param visit - The function to call for every entry.
+* @param context - Passed to visit on every call.
+* @return
+* 	PQ_NULL_ARGUMENT - if queue or visit is NULL.
+* 	PQ_ERROR - if queue is an external-memory queue.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqForEach(PriorityQueue queue, VisitPQEntry visit, void *context);
+
+/**
+* pqForEachParallel: Calls visit for every element in the priority queue together with its priority, splitting
+* the entries between threads_count threads (POSIX threads). The calls are made in no particular order,
+* so it is meant for order-insensitive work such as sums or histograms.
+* Every thread gets at least 256 entries, so a queue with fewer than 512 entries (or threads_count 1) is visited
+* by the calling thread alone, in order, as in pqForEach.
+* visit must be thread-safe and must not change the priority queue. It does not use or change the internal iterator.
+*
+* @param queue - The priority queue to visit.
+* @param visit - The function to call for every entry.
+* @param context - Passed to visit on every call (from all the threads).
+* @param threads_count - The maximal amount of threads to use (including the calling thread). Must be positive.
+* @return
+* 	PQ_NULL_ARGUMENT - if queue or visit is NULL.
+* 	PQ_ERROR - if queue is an external-memory queue or threads_count is not positive.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqForEachParallel(PriorityQueue queue, VisitPQEntry visit, void *context, int threads_count);
+
 /*!
 * Macro for iterating over a priority queue.
 * Declares a new iterator for the loop.
@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include "skip_list.h"
+
+#define SKIP_LIST_MAX_HEIGHT 32
+
+/* The express links of a node of the bottom list. A tower of height h is linked into levels 1..h, and next[i]
+ * is the next tower in level i + 1 (all the towers of a level are in the same order as their nodes) */
+typedef struct skipTower {
+    LinkedNode node;
+    int height;
+    struct skipTower *next[];
+} *SkipTower;
+
+struct skipList {
+    LinkedList list;
+    CompareNodeData compare;
+    int height;
+    SkipTower heads[SKIP_LIST_MAX_HEIGHT];
+    unsigned int random_state;
+};
+
+/* Returns the tower after tower in level (1-based), where a NULL tower stands for the start of the level */
+static SkipTower getNextTower(SkipList skip_list, SkipTower tower, int level) {
+    return tower == NULL ? skip_list->heads[level - 1] : tower->next[level - 1];
+}
+
+static void setNextTower(SkipList skip_list, SkipTower tower, int level, SkipTower next_tower) {
+    if (tower == NULL) {
+        skip_list->heads[level - 1] = next_tower;
+    } else {
+        tower->next[level - 1] = next_tower;
+    }
+}
+
+/* Draws the height of a new tower: 0 (no tower) with probability 1/2, 1 with probability 1/4 and so on */
+static int getRandomHeight(SkipList skip_list) {
+    // xorshift32
+    unsigned int state = skip_list->random_state;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    skip_list->random_state = state;
+
+    int height = 0;
+    while ((state & 1) && height < SKIP_LIST_MAX_HEIGHT) {
+        height++;
+        state >>= 1;
+    }
+    return height;
+}
+
+/* Returns whether the data of tower's node comes before data. If is_equal_before is true, equal data comes
+ * before data too */
+static bool isBefore(SkipList skip_list, SkipTower tower, NodeData data, bool is_equal_before) {
+    int comparison = skip_list->compare(listGetData(tower->node), data);
+    return comparison < 0 || (is_equal_before && comparison == 0);
+}
+
+/* Fills previous_towers with the last tower before data in every level (NULL for the start of the level), and
+ * returns the last node before data in the bottom list (NULL if there is none) */
+static LinkedNode findPrevious(SkipList skip_list, NodeData data, bool is_equal_before, SkipTower *previous_towers) {
+    SkipTower tower = NULL;
+    for (int level = skip_list->height; level >= 1; level--) {
+        SkipTower next_tower = getNextTower(skip_list, tower, level);
+        while (next_tower != NULL && isBefore(skip_list, next_tower, data, is_equal_before)) {
+            tower = next_tower;
+            next_tower = getNextTower(skip_list, tower, level);
+        }
+        if (previous_towers != NULL) {
+            previous_towers[level - 1] = tower;
+        }
+    }
+
+    // The rest of the way is in the bottom list, where about one node in two has no tower
+    LinkedNode node = tower != NULL ? tower->node : NULL;
+    LinkedNode next_node = node != NULL ? listGetNext(node) : listGetFirst(skip_list->list);
+    while (next_node != NULL) {
+        int comparison = skip_list->compare(listGetData(next_node), data);
+        if (comparison > 0 || (comparison == 0 && !is_equal_before)) {
+            break;
+        }
+        node = next_node;
+        next_node = listGetNext(node);
+    }
+    return node;
+}
+
+
+SkipList skipListCreate(CompareNodeData compare) {
+    if (compare == NULL) {
+        return NULL;
+    }
+
+    SkipList skip_list = malloc(sizeof(*skip_list));
+    if (skip_list == NULL) {
+        return NULL;
+    }
+    skip_list->list = listCreate();
+    if (skip_list->list == NULL) {
+        free(skip_list);
+        return NULL;
+    }
+
+    skip_list->compare = compare;
+    skip_list->height = 0;
+    for (int i = 0; i < SKIP_LIST_MAX_HEIGHT; i++) {
+        skip_list->heads[i] = NULL;
+    }
+    skip_list->random_state = 2463534242u;
+    return skip_list;
+}
+
+void skipListDestroy(SkipList skip_list) {
+    if (skip_list == NULL) {
+        return;
+    }
+
+    // Every tower is in level 1
+    SkipTower tower = skip_list->height > 0 ? skip_list->heads[0] : NULL;
+    while (tower != NULL) {
+        SkipTower next_tower = tower->next[0];
+        free(tower);
+        tower = next_tower;
+    }
+    listDestroy(skip_list->list);
+    free(skip_list);
+}
+
+int skipListGetSize(SkipList skip_list) {
+    if (skip_list == NULL) {
+        return -1;
+    }
+    return listGetSize(skip_list->list);
+}
+
+int64_t skipListGetSize64(SkipList skip_list) {
+    if (skip_list == NULL) {
+        return -1;
+    }
+    return listGetSize64(skip_list->list);
+}
+
+LinkedList skipListGetList(SkipList skip_list) {
+    if (skip_list == NULL) {
+        return NULL;
+    }
+    return skip_list->list;
+}
+
+LinkedNode skipListInsertOrdered(SkipList skip_list, NodeData data) {
+    if (skip_list == NULL || data == NULL) {
+        return NULL;
+    }
+
+    SkipTower previous_towers[SKIP_LIST_MAX_HEIGHT];
+    LinkedNode previous_node = findPrevious(skip_list, data, true, previous_towers);
+
+    int height = getRandomHeight(skip_list);
+    SkipTower tower = NULL;
+    if (height > 0) {
+        tower = malloc(sizeof(*tower) + height * sizeof(tower->next[0]));
+        if (tower == NULL) {
+            return NULL;
+        }
+    }
+
+    LinkedNode node = previous_node != NULL ? listInsertAfter(skip_list->list, previous_node, data)
+                                            : listInsertStart(skip_list->list, data);
+    if (node == NULL) {
+        free(tower);
+        return NULL;
+    }
+    if (tower == NULL) {
+        return node;
+    }
+
+    tower->node = node;
+    tower->height = height;
+    for (int level = 1; level <= height; level++) {
+        SkipTower previous_tower = level <= skip_list->height ? previous_towers[level - 1] : NULL;
+        tower->next[level - 1] = getNextTower(skip_list, previous_tower, level);
+        setNextTower(skip_list, previous_tower, level, tower);
+    }
+    if (height > skip_list->height) {
+        skip_list->height = height;
+    }
+    return node;
+}
+
+LinkedNode skipListFindFirstGreaterOrEqual(SkipList skip_list, NodeData data) {
+    if (skip_list == NULL || data == NULL) {
+        return NULL;
+    }
+
+    LinkedNode previous_node = findPrevious(skip_list, data, false, NULL);
+    return previous_node != NULL ? listGetNext(previous_node) : listGetFirst(skip_list->list);
+}
+
+bool skipListRemove(SkipList skip_list, LinkedNode node) {
+    if (skip_list == NULL || node == NULL) {
+        return false;
+    }
+
+    // The towers of the equal items are passed one by one, looking for the node's own tower in every level
+    NodeData data = listGetData(node);
+    SkipTower previous_towers[SKIP_LIST_MAX_HEIGHT];
+    findPrevious(skip_list, data, false, previous_towers);
+    SkipTower removed_tower = NULL;
+    for (int level = skip_list->height; level >= 1; level--) {
+        SkipTower tower = previous_towers[level - 1];
+        SkipTower next_tower = getNextTower(skip_list, tower, level);
+        while (next_tower != NULL && next_tower->node != node && isBefore(skip_list, next_tower, data, true)) {
+            tower = next_tower;
+            next_tower = getNextTower(skip_list, tower, level);
+        }
+        if (next_tower != NULL && next_tower->node == node) {
+            setNextTower(skip_list, tower, level, next_tower->next[level - 1]);
+            removed_tower = next_tower;
+        }
+    }
+
+    while (skip_list->height > 0 && skip_list->heads[skip_list->height - 1] == NULL) {
+        skip_list->height--;
+    }
+    free(removed_tower);
+    listRemove(skip_list->list, node);
+    return true;
+}
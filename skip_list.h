@@ -0,0 +1,47 @@
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
+#include <stdbool.h>
+#include "double_linked_list.h"
+
+/* An ordered skip list built on LinkedList. All the items are kept in ascending order (by a compare function) in
+ * a regular LinkedList, which is the bottom level of the skip list, so it can be read with LIST_FOREACH and the
+ * other LinkedList reading functions (see skipListGetList). About half of the nodes also get a tower of express
+ * links to nodes further ahead, which make insertion, search and removal take O(log n) expected time.
+ * Items with equal data are kept in their insertion order. LinkedNode handles stay valid until their own node is
+ * removed. The skip list does not own the data inserted to it */
+
+/* Type for defining the skip list controller object */
+typedef struct skipList *SkipList;
+
+
+/* Creates a new skip list ordered by compare. Returns NULL if compare is NULL or allocations failed */
+SkipList skipListCreate(CompareNodeData compare);
+
+/* Frees all the memory allocated by the skip list (does not free the data inserted to it) */
+void skipListDestroy(SkipList skip_list);
+
+/* Returns the amount of items in the skip list, or INT_MAX if there are more. Returns -1 if skip_list is NULL */
+int skipListGetSize(SkipList skip_list);
+
+/* Returns the amount of items in the skip list, which may exceed INT_MAX. Returns -1 if skip_list is NULL */
+int64_t skipListGetSize64(SkipList skip_list);
+
+/* Returns the bottom level of the skip list, which holds all of its items in order. The list may be read, but
+ * must only be changed through the skip list functions */
+LinkedList skipListGetList(SkipList skip_list);
+
+/* Inserts data in its place by order, after all the items equal to it, in O(log n) expected time.
+ * Returns its node, or NULL if a NULL was sent or allocations failed */
+LinkedNode skipListInsertOrdered(SkipList skip_list, NodeData data);
+
+/* Returns the first node whose data is greater than or equal to data, in O(log n) expected time, or NULL if
+ * there is no such node */
+LinkedNode skipListFindFirstGreaterOrEqual(SkipList skip_list, NodeData data);
+
+/* Removes node from the skip list. Takes O(log n) expected time, plus the amount of items equal to the node's data
+ * (between which the node is found by identity). Returns false if a NULL was sent */
+bool skipListRemove(SkipList skip_list, LinkedNode node);
+
+
+#endif //SKIP_LIST_H
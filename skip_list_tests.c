@@ -0,0 +1,187 @@
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "skip_list.h"
+
+#define ITEMS_COUNT 1000
+
+typedef struct {
+    int key;
+    int order;
+} KeyedItem;
+
+
+static int compareKeys(NodeData first, NodeData second) {
+    return ((KeyedItem *) first)->key - ((KeyedItem *) second)->key;
+}
+
+/* Returns whether the bottom list of the skip list is sorted by key, and by order between equal keys */
+static bool isSortedStably(SkipList skip_list) {
+    KeyedItem *prev_item = NULL;
+    int count = 0;
+    LIST_FOREACH(skipListGetList(skip_list), node) {
+        KeyedItem *item = listGetData(node);
+        if (prev_item != NULL && (prev_item->key > item->key ||
+                                  (prev_item->key == item->key && prev_item->order > item->order))) {
+            return false;
+        }
+        prev_item = item;
+        count++;
+    }
+    return count == skipListGetSize(skip_list);
+}
+
+/* Inserts ITEMS_COUNT items with keys in [0, 100) in a scrambled order to the skip list */
+static bool insertItems(SkipList skip_list, KeyedItem *items, LinkedNode *nodes) {
+    for (int i = 0; i < ITEMS_COUNT; i++) {
+        items[i].key = (i * 7919) % 100;
+        items[i].order = i;
+        nodes[i] = skipListInsertOrdered(skip_list, &items[i]);
+        if (nodes[i] == NULL || listGetData(nodes[i]) != &items[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/* ============= TESTING skipListCreate ============= */
+bool testSkipListCreate() {
+    bool result = true;
+    SkipList skip_list = skipListCreate(NULL);
+    ASSERT_TEST(skip_list == NULL, destroy);
+    skip_list = skipListCreate(compareKeys);
+    ASSERT_TEST(skip_list != NULL, destroy);
+    ASSERT_TEST(skipListGetSize(skip_list) == 0, destroy);
+    ASSERT_TEST(listGetFirst(skipListGetList(skip_list)) == NULL, destroy);
+    KeyedItem item = {1, 0};
+    ASSERT_TEST(skipListFindFirstGreaterOrEqual(skip_list, &item) == NULL, destroy);
+
+    destroy:
+    skipListDestroy(skip_list);
+    return result;
+}
+
+/* ============= TESTING skipListInsertOrdered ============= */
+bool testSkipListInsertOrderedKeepsOrder() {
+    bool result = true;
+    SkipList skip_list = skipListCreate(compareKeys);
+    KeyedItem items[ITEMS_COUNT];
+    LinkedNode nodes[ITEMS_COUNT];
+    ASSERT_TEST(insertItems(skip_list, items, nodes), destroy);
+    ASSERT_TEST(skipListGetSize(skip_list) == ITEMS_COUNT, destroy);
+    ASSERT_TEST(skipListGetSize64(skip_list) == ITEMS_COUNT, destroy);
+    ASSERT_TEST(skipListGetSize64(NULL) == -1, destroy);
+    ASSERT_TEST(isSortedStably(skip_list), destroy);
+
+    destroy:
+    skipListDestroy(skip_list);
+    return result;
+}
+
+/* ============= TESTING skipListFindFirstGreaterOrEqual ============= */
+bool testSkipListFindFirstGreaterOrEqual() {
+    bool result = true;
+    SkipList skip_list = skipListCreate(compareKeys);
+    KeyedItem items[ITEMS_COUNT];
+    LinkedNode nodes[ITEMS_COUNT];
+    ASSERT_TEST(insertItems(skip_list, items, nodes), destroy);
+
+    for (int key = -1; key <= 100; key++) {
+        KeyedItem item = {key, 0};
+        LinkedNode found_node = skipListFindFirstGreaterOrEqual(skip_list, &item);
+        if (key >= 99) {
+            ASSERT_TEST(key == 100 ? found_node == NULL : ((KeyedItem *) listGetData(found_node))->key == 99, destroy);
+            continue;
+        }
+        // The first of the equal items, since every key from 0 to 99 was inserted
+        KeyedItem *found_item = listGetData(found_node);
+        ASSERT_TEST(found_item->key == (key < 0 ? 0 : key), destroy);
+        LinkedNode prev_node = listGetPrev(found_node);
+        ASSERT_TEST(prev_node == NULL || ((KeyedItem *) listGetData(prev_node))->key < found_item->key, destroy);
+    }
+
+    destroy:
+    skipListDestroy(skip_list);
+    return result;
+}
+
+/* ============= TESTING skipListRemove ============= */
+bool testSkipListRemoveByHandle() {
+    bool result = true;
+    SkipList skip_list = skipListCreate(compareKeys);
+    KeyedItem items[ITEMS_COUNT];
+    LinkedNode nodes[ITEMS_COUNT];
+    ASSERT_TEST(insertItems(skip_list, items, nodes), destroy);
+
+    // Removes every third item, some of them between equal items, and the other handles stay valid
+    for (int i = 0; i < ITEMS_COUNT; i += 3) {
+        ASSERT_TEST(skipListRemove(skip_list, nodes[i]), destroy);
+    }
+    ASSERT_TEST(skipListGetSize(skip_list) == ITEMS_COUNT - (ITEMS_COUNT + 2) / 3, destroy);
+    ASSERT_TEST(isSortedStably(skip_list), destroy);
+    for (int i = 1; i < ITEMS_COUNT; i += 3) {
+        ASSERT_TEST(listGetData(nodes[i]) == &items[i], destroy);
+    }
+
+    // Searching still works after the towers were removed
+    for (int i = 1; i < ITEMS_COUNT; i++) {
+        if (i % 3 != 0) {
+            ASSERT_TEST(skipListRemove(skip_list, nodes[i]), destroy);
+        }
+    }
+    ASSERT_TEST(skipListGetSize(skip_list) == 0, destroy);
+    ASSERT_TEST(skipListInsertOrdered(skip_list, &items[0]) != NULL, destroy);
+    ASSERT_TEST(skipListFindFirstGreaterOrEqual(skip_list, &items[0]) != NULL, destroy);
+
+    destroy:
+    skipListDestroy(skip_list);
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testSkipListCreate,
+        testSkipListInsertOrderedKeepsOrder,
+        testSkipListFindFirstGreaterOrEqual,
+        testSkipListRemoveByHandle
+};
+
+const char *testNames[] = {
+        "testSkipListCreate",
+        "testSkipListInsertOrderedKeepsOrder",
+        "testSkipListFindFirstGreaterOrEqual",
+        "testSkipListRemoveByHandle"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testSkipListCreate",
+        "Please refer to the testing code at function: testSkipListInsertOrderedKeepsOrder",
+        "Please refer to the testing code at function: testSkipListFindFirstGreaterOrEqual",
+        "Please refer to the testing code at function: testSkipListRemoveByHandle"
+};
+
+
+#define NUMBER_TESTS 4
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: skip_list_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}
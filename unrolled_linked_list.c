@@ -0,0 +1,280 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "unrolled_linked_list.h"
+
+#define NULL_POSITION ((UnrolledPosition) {NULL, 0})
+
+struct unrolledBlock {
+    UnrolledBlock prev;
+    UnrolledBlock next;
+    int count;
+    NodeData items[UNROLLED_BLOCK_CAPACITY];
+};
+
+struct unrolledList {
+    UnrolledBlock head;
+    UnrolledBlock tail;
+    int64_t size;
+    AllocateFunction allocate;
+    DeallocateFunction deallocate;
+    void *allocator_context;
+};
+
+/* The allocation function used by lists that were created without an allocator */
+static void *defaultAllocate(size_t size, void *context) {
+    (void) context;
+    return malloc(size);
+}
+
+/* The deallocation function used by lists that were created without an allocator */
+static void defaultDeallocate(void *memory, void *context) {
+    (void) context;
+    free(memory);
+}
+
+static UnrolledPosition createPosition(UnrolledBlock block, int index) {
+    UnrolledPosition position = {block, index};
+    return position;
+}
+
+/* Allocates a new empty block and links it into the list right after previous_block (or at the start if it is
+ * NULL) */
+static UnrolledBlock createBlockAfter(UnrolledList list, UnrolledBlock previous_block) {
+    UnrolledBlock block = list->allocate(sizeof(struct unrolledBlock), list->allocator_context);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->count = 0;
+
+    block->prev = previous_block;
+    block->next = previous_block != NULL ? previous_block->next : list->head;
+    if (block->next != NULL) {
+        block->next->prev = block;
+    } else {
+        list->tail = block;
+    }
+    if (previous_block != NULL) {
+        previous_block->next = block;
+    } else {
+        list->head = block;
+    }
+    return block;
+}
+
+/* Unlinks a block from the list and frees it */
+static void destroyBlock(UnrolledList list, UnrolledBlock block) {
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        list->head = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    } else {
+        list->tail = block->prev;
+    }
+    list->deallocate(block, list->allocator_context);
+}
+
+/* Inserts data at index of block, which must not be full */
+static void insertToBlock(UnrolledBlock block, int index, NodeData data) {
+    memmove(&block->items[index + 1], &block->items[index], (block->count - index) * sizeof(NodeData));
+    block->items[index] = data;
+    block->count++;
+}
+
+/* Inserts data at index of block (index may be block->count). A full block is split in half first, so both
+ * halves have room for later insertions */
+static UnrolledPosition insertAt(UnrolledList list, UnrolledBlock block, int index, NodeData data) {
+    if (block->count == UNROLLED_BLOCK_CAPACITY) {
+        UnrolledBlock new_block = createBlockAfter(list, block);
+        if (new_block == NULL) {
+            return NULL_POSITION;
+        }
+
+        int kept_count = UNROLLED_BLOCK_CAPACITY / 2;
+        new_block->count = UNROLLED_BLOCK_CAPACITY - kept_count;
+        memcpy(new_block->items, &block->items[kept_count], new_block->count * sizeof(NodeData));
+        block->count = kept_count;
+        if (index > kept_count) {
+            block = new_block;
+            index -= kept_count;
+        }
+    }
+
+    insertToBlock(block, index, data);
+    list->size++;
+    return createPosition(block, index);
+}
+
+
+UnrolledList unrolledListCreate() {
+    return unrolledListCreateWithAllocator(defaultAllocate, defaultDeallocate, NULL);
+}
+
+UnrolledList unrolledListCreateWithAllocator(AllocateFunction allocate, DeallocateFunction deallocate,
+                                             void *context) {
+    if (allocate == NULL || deallocate == NULL) {
+        return NULL;
+    }
+
+    UnrolledList list = allocate(sizeof(struct unrolledList), context);
+    if (list == NULL) {
+        return NULL;
+    }
+
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+    list->allocate = allocate;
+    list->deallocate = deallocate;
+    list->allocator_context = context;
+
+    return list;
+}
+
+int unrolledListGetSize(UnrolledList list) {
+    if (list == NULL) {
+        return -1;
+    }
+    return list->size < INT_MAX ? (int) list->size : INT_MAX;
+}
+
+int64_t unrolledListGetSize64(UnrolledList list) {
+    if (list == NULL) {
+        return -1;
+    }
+    return list->size;
+}
+
+void unrolledListDestroy(UnrolledList list) {
+    if (list == NULL) {
+        return;
+    }
+
+    unrolledListClear(list);
+    list->deallocate(list, list->allocator_context);
+}
+
+void unrolledListClear(UnrolledList list) {
+    if (list == NULL) {
+        return;
+    }
+
+    UnrolledBlock block = list->head;
+    while (block != NULL) {
+        UnrolledBlock next_block = block->next;
+        list->deallocate(block, list->allocator_context);
+        block = next_block;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
+
+UnrolledPosition unrolledListRemove(UnrolledList list, UnrolledPosition position) {
+    if (list == NULL || !unrolledListIsValid(position)) {
+        return NULL_POSITION;
+    }
+
+    UnrolledBlock block = position.block;
+    int index = position.index;
+    block->count--;
+    memmove(&block->items[index], &block->items[index + 1], (block->count - index) * sizeof(NodeData));
+    list->size--;
+
+    if (block->count == 0) {
+        UnrolledBlock next_block = block->next;
+        destroyBlock(list, block);
+        return createPosition(next_block, 0);
+    }
+
+    // Blocks that got less than half full are merged with the next block if both fit in one, or borrow items
+    // from it otherwise, so every block but the last stays at least half full
+    UnrolledBlock next_block = block->next;
+    if (next_block != NULL && block->count < UNROLLED_BLOCK_CAPACITY / 2) {
+        if (block->count + next_block->count <= UNROLLED_BLOCK_CAPACITY) {
+            memcpy(&block->items[block->count], next_block->items, next_block->count * sizeof(NodeData));
+            block->count += next_block->count;
+            destroyBlock(list, next_block);
+        } else {
+            int borrowed_count = UNROLLED_BLOCK_CAPACITY / 2 - block->count;
+            memcpy(&block->items[block->count], next_block->items, borrowed_count * sizeof(NodeData));
+            block->count += borrowed_count;
+            next_block->count -= borrowed_count;
+            memmove(next_block->items, &next_block->items[borrowed_count], next_block->count * sizeof(NodeData));
+        }
+    }
+
+    if (index == block->count) {
+        return createPosition(block->next, 0);
+    }
+    return createPosition(block, index);
+}
+
+UnrolledPosition unrolledListInsertAfter(UnrolledList list, UnrolledPosition position, NodeData data) {
+    if (list == NULL || !unrolledListIsValid(position)) {
+        return NULL_POSITION;
+    }
+    return insertAt(list, position.block, position.index + 1, data);
+}
+
+UnrolledPosition unrolledListInsertStart(UnrolledList list, NodeData data) {
+    if (list == NULL) {
+        return NULL_POSITION;
+    }
+    if (list->head == NULL && createBlockAfter(list, NULL) == NULL) {
+        return NULL_POSITION;
+    }
+    return insertAt(list, list->head, 0, data);
+}
+
+bool unrolledListIsValid(UnrolledPosition position) {
+    return position.block != NULL && position.index >= 0 && position.index < position.block->count;
+}
+
+NodeData unrolledListGetData(UnrolledPosition position) {
+    if (!unrolledListIsValid(position)) {
+        return NULL;
+    }
+    return position.block->items[position.index];
+}
+
+UnrolledPosition unrolledListGetNext(UnrolledPosition position) {
+    if (position.block == NULL) {
+        return NULL_POSITION;
+    }
+    if (position.index + 1 < position.block->count) {
+        return createPosition(position.block, position.index + 1);
+    }
+    return createPosition(position.block->next, 0);
+}
+
+UnrolledPosition unrolledListGetPrev(UnrolledPosition position) {
+    if (position.block == NULL) {
+        return NULL_POSITION;
+    }
+    if (position.index > 0) {
+        return createPosition(position.block, position.index - 1);
+    }
+    UnrolledBlock prev_block = position.block->prev;
+    if (prev_block == NULL) {
+        return NULL_POSITION;
+    }
+    return createPosition(prev_block, prev_block->count - 1);
+}
+
+UnrolledPosition unrolledListGetFirst(UnrolledList list) {
+    if (list == NULL || list->head == NULL) {
+        return NULL_POSITION;
+    }
+    return createPosition(list->head, 0);
+}
+
+UnrolledPosition unrolledListGetLast(UnrolledList list) {
+    if (list == NULL || list->tail == NULL) {
+        return NULL_POSITION;
+    }
+    return createPosition(list->tail, list->tail->count - 1);
+}
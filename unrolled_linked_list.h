@@ -0,0 +1,83 @@
+#ifndef UNROLLED_LINKED_LIST_H
+#define UNROLLED_LINKED_LIST_H
+
+#include <stdbool.h>
+#include "allocator.h"
+#include "double_linked_list.h"
+
+/* An unrolled linked list: a doubly linked list of blocks, each holding up to UNROLLED_BLOCK_CAPACITY items in an
+ * array, so a sequential scan reads whole blocks instead of chasing a pointer for every item.
+ * Every block but the last is kept at least half full, by splitting full blocks on insertion and by merging or
+ * rebalancing a block with the next one on removal.
+ * The API is the same as the one of LinkedList, except that items are referred to by UnrolledPosition values
+ * instead of nodes. Inserting or removing an item moves the items after it in the same block, so it invalidates
+ * all the positions after it in the list (the returned position is always valid) */
+
+#define UNROLLED_BLOCK_CAPACITY 16
+
+/* Type for defining the list blocks */
+typedef struct unrolledBlock *UnrolledBlock;
+/* Type for defining the list controller object */
+typedef struct unrolledList *UnrolledList;
+
+/* The position of an item in the list. A position with a NULL block is past the end (or before the start) */
+typedef struct unrolledPosition {
+    UnrolledBlock block;
+    int index;
+} UnrolledPosition;
+
+
+/* Creates a new list */
+UnrolledList unrolledListCreate();
+
+/* Creates a new list that allocates the list and all of its blocks with allocate and frees them with deallocate.
+ * context is passed to both functions on every call */
+UnrolledList unrolledListCreateWithAllocator(AllocateFunction allocate, DeallocateFunction deallocate,
+                                             void *context);
+
+/* Returns the amount of items currently in the list, or INT_MAX if there are more. Returns -1 if list is NULL */
+int unrolledListGetSize(UnrolledList list);
+
+/* Returns the amount of items currently in the list, which may exceed INT_MAX. Returns -1 if list is NULL */
+int64_t unrolledListGetSize64(UnrolledList list);
+
+/* Frees all the memory allocated by the list (does not free the data inserted to the list) */
+void unrolledListDestroy(UnrolledList list);
+
+/* Removes all the items from the list and frees its blocks (does not free the data inserted to the list) */
+void unrolledListClear(UnrolledList list);
+
+/* Removes the item at position from the list and returns the position of the item that was after it */
+UnrolledPosition unrolledListRemove(UnrolledList list, UnrolledPosition position);
+
+/* Inserts an item after the item at position and returns its position */
+UnrolledPosition unrolledListInsertAfter(UnrolledList list, UnrolledPosition position, NodeData data);
+
+/* Inserts an item at the start of the list and returns its position */
+UnrolledPosition unrolledListInsertStart(UnrolledList list, NodeData data);
+
+/* Returns whether position points to an item (and is not past the end of the list) */
+bool unrolledListIsValid(UnrolledPosition position);
+
+/* Returns the item at position */
+NodeData unrolledListGetData(UnrolledPosition position);
+
+/* Returns the position of the item after the one at position */
+UnrolledPosition unrolledListGetNext(UnrolledPosition position);
+
+/* Returns the position of the item before the one at position */
+UnrolledPosition unrolledListGetPrev(UnrolledPosition position);
+
+/* Returns the position of the first item of the list */
+UnrolledPosition unrolledListGetFirst(UnrolledList list);
+
+/* Returns the position of the last item of the list */
+UnrolledPosition unrolledListGetLast(UnrolledList list);
+
+/* Macro to iterate over all of the list items */
+#define UNROLLED_LIST_FOREACH(list, iter) \
+    for(UnrolledPosition iter = unrolledListGetFirst(list); unrolledListIsValid(iter); \
+        iter = unrolledListGetNext(iter))
+
+
+#endif //UNROLLED_LINKED_LIST_H
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "test_utilities.h"
+#include "unrolled_linked_list.h"
+
+#define ITEMS_COUNT 100
+
+
+static NodeData getItem(int number) {
+    return (NodeData) (intptr_t) number;
+}
+
+static int getNumber(UnrolledPosition position) {
+    return (int) (intptr_t) unrolledListGetData(position);
+}
+
+/* Creates a list of the numbers 0..ITEMS_COUNT-1 in order */
+UnrolledList createNumbersList() {
+    UnrolledList list = unrolledListCreate();
+    UnrolledPosition last_position = unrolledListInsertStart(list, getItem(0));
+    for (int i = 1; i < ITEMS_COUNT; i++) {
+        last_position = unrolledListInsertAfter(list, last_position, getItem(i));
+    }
+    return list;
+}
+
+
+/* ============= TESTING unrolledListCreate ============= */
+bool testUnrolledListCreateIsEmpty() {
+    bool result = true;
+    UnrolledList list = unrolledListCreate();
+    ASSERT_TEST(list != NULL, destroy);
+    ASSERT_TEST(unrolledListGetSize(list) == 0, destroy);
+    ASSERT_TEST(!unrolledListIsValid(unrolledListGetFirst(list)), destroy);
+    ASSERT_TEST(!unrolledListIsValid(unrolledListGetLast(list)), destroy);
+    ASSERT_TEST(unrolledListGetSize(NULL) == -1, destroy);
+    ASSERT_TEST(unrolledListGetSize64(NULL) == -1, destroy);
+    ASSERT_TEST(unrolledListCreateWithAllocator(NULL, NULL, NULL) == NULL, destroy);
+
+    destroy:
+    unrolledListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING unrolledListInsertAfter ============= */
+bool testUnrolledListKeepsOrderAcrossBlocks() {
+    bool result = true;
+    UnrolledList list = createNumbersList();
+    ASSERT_TEST(unrolledListGetSize(list) == ITEMS_COUNT, destroy);
+
+    int expected = 0;
+    UNROLLED_LIST_FOREACH(list, position) {
+        ASSERT_TEST(getNumber(position) == expected, destroy);
+        expected++;
+    }
+    ASSERT_TEST(expected == ITEMS_COUNT, destroy);
+
+    // Backwards too
+    UnrolledPosition position = unrolledListGetLast(list);
+    for (int i = ITEMS_COUNT - 1; i >= 0; i--) {
+        ASSERT_TEST(getNumber(position) == i, destroy);
+        position = unrolledListGetPrev(position);
+    }
+    ASSERT_TEST(!unrolledListIsValid(position), destroy);
+
+    destroy:
+    unrolledListDestroy(list);
+    return result;
+}
+
+bool testUnrolledListInsertInTheMiddleOfFullBlocks() {
+    bool result = true;
+    UnrolledList list = unrolledListCreate();
+    // Every item is inserted right after the first one, so it always goes to the middle of the first blocks
+    UnrolledPosition first_position = unrolledListInsertStart(list, getItem(0));
+    for (int i = ITEMS_COUNT - 1; i > 0; i--) {
+        ASSERT_TEST(getNumber(unrolledListInsertAfter(list, first_position, getItem(i))) == i, destroy);
+    }
+    ASSERT_TEST(unrolledListGetSize(list) == ITEMS_COUNT, destroy);
+
+    int expected = 0;
+    UNROLLED_LIST_FOREACH(list, position) {
+        ASSERT_TEST(getNumber(position) == expected, destroy);
+        expected++;
+    }
+
+    destroy:
+    unrolledListDestroy(list);
+    return result;
+}
+
+/* ============= TESTING unrolledListRemove ============= */
+bool testUnrolledListRemoveReturnsNextItem() {
+    bool result = true;
+    UnrolledList list = createNumbersList();
+
+    // Removes the odd numbers
+    UnrolledPosition position = unrolledListGetNext(unrolledListGetFirst(list));
+    while (unrolledListIsValid(position)) {
+        position = unrolledListRemove(list, position);
+        position = unrolledListGetNext(position);
+    }
+    ASSERT_TEST(unrolledListGetSize(list) == ITEMS_COUNT / 2, destroy);
+    ASSERT_TEST(unrolledListGetSize64(list) == ITEMS_COUNT / 2, destroy);
+
+    int expected = 0;
+    UNROLLED_LIST_FOREACH(list, even_position) {
+        ASSERT_TEST(getNumber(even_position) == expected, destroy);
+        expected += 2;
+    }
+
+    // And then all the rest
+    position = unrolledListGetFirst(list);
+    while (unrolledListIsValid(position)) {
+        position = unrolledListRemove(list, position);
+    }
+    ASSERT_TEST(unrolledListGetSize(list) == 0, destroy);
+    ASSERT_TEST(!unrolledListIsValid(unrolledListGetFirst(list)), destroy);
+
+    destroy:
+    unrolledListDestroy(list);
+    return result;
+}
+
+/* Checks that every block of the list but the last holds at least half of UNROLLED_BLOCK_CAPACITY items */
+static bool areBlocksHalfFull(UnrolledList list) {
+    UnrolledBlock block = NULL;
+    int block_count = 0;
+    UNROLLED_LIST_FOREACH(list, position) {
+        if (position.block != block) {
+            if (block != NULL && block_count < UNROLLED_BLOCK_CAPACITY / 2) {
+                return false;
+            }
+            block = position.block;
+            block_count = 0;
+        }
+        block_count++;
+    }
+    return true;
+}
+
+bool testUnrolledListRemoveKeepsBlocksHalfFull() {
+    bool result = true;
+    UnrolledList list = createNumbersList();
+    ASSERT_TEST(areBlocksHalfFull(list), destroy);
+
+    // Removes two of every three numbers, in the order that leaves the most gaps behind
+    UnrolledPosition position = unrolledListGetFirst(list);
+    while (unrolledListIsValid(position)) {
+        position = unrolledListGetNext(position);
+        for (int i = 0; i < 2 && unrolledListIsValid(position); i++) {
+            position = unrolledListRemove(list, position);
+        }
+        ASSERT_TEST(areBlocksHalfFull(list), destroy);
+    }
+    ASSERT_TEST(unrolledListGetSize(list) == (ITEMS_COUNT + 2) / 3, destroy);
+
+    int expected = 0;
+    UNROLLED_LIST_FOREACH(list, kept_position) {
+        ASSERT_TEST(getNumber(kept_position) == expected, destroy);
+        expected += 3;
+    }
+
+    destroy:
+    unrolledListDestroy(list);
+    return result;
+}
+
+
+bool (*tests[])(void) = {
+        testUnrolledListCreateIsEmpty,
+        testUnrolledListKeepsOrderAcrossBlocks,
+        testUnrolledListInsertInTheMiddleOfFullBlocks,
+        testUnrolledListRemoveReturnsNextItem,
+        testUnrolledListRemoveKeepsBlocksHalfFull
+};
+
+const char *testNames[] = {
+        "testUnrolledListCreateIsEmpty",
+        "testUnrolledListKeepsOrderAcrossBlocks",
+        "testUnrolledListInsertInTheMiddleOfFullBlocks",
+        "testUnrolledListRemoveReturnsNextItem",
+        "testUnrolledListRemoveKeepsBlocksHalfFull"
+};
+
+const char *testFailDescriptions[] = {
+        "Please refer to the testing code at function: testUnrolledListCreateIsEmpty",
+        "Please refer to the testing code at function: testUnrolledListKeepsOrderAcrossBlocks",
+        "Please refer to the testing code at function: testUnrolledListInsertInTheMiddleOfFullBlocks",
+        "Please refer to the testing code at function: testUnrolledListRemoveReturnsNextItem",
+        "Please refer to the testing code at function: testUnrolledListRemoveKeepsBlocksHalfFull"
+};
+
+
+#define NUMBER_TESTS 5
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++) {
+            RUN_TEST(tests[test_idx], testNames[test_idx], testFailDescriptions[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: unrolled_linked_list_tests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS) {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1], testFailDescriptions[test_idx - 1]);
+    return 0;
+
+}